@@ -18,14 +18,27 @@
 struct IOOptions {
 
     // default-constructed fs::path are empty string. This is fine, they will fail all checks such as fs::is_directory and fs::exists.
-    IOOptions() : inDirectory(), outDirectory(), subtractAlphaFromIndex(false), useSubFolders(false) {}
+    IOOptions() : inDirectory(), outDirectory(), fileList(), groundIndexOffset(0), deflateBackend(DeflateBackend::LODEPNG), compressionProfile(CompressionProfile::DEFAULT), chunkPolicy(), outputFormat(OutputFormat::PNG), archiveFormat(ArchiveFormat::NONE), writeBackend(WriteBackend::URING), subtractAlphaFromIndex(false), useSubFolders(false), reduceColors(false), planOnly(false), bundle(false), atlas(false), animate(false), recompress(false) {}
 
     explicit IOOptions(const SplitterOpts & splitterOpts)
         :   inDirectory(std::filesystem::path(splitterOpts.inDirectory).make_preferred()),
             outDirectory(std::filesystem::path(splitterOpts.outDirectory).make_preferred()),
+            fileList(splitterOpts.fileList),
             groundIndexOffset(splitterOpts.groundIndexOffset.second),
+            deflateBackend(splitterOpts.deflateBackend),
+            compressionProfile(splitterOpts.compressionProfile),
+            chunkPolicy(splitterOpts.chunkPolicy),
+            outputFormat(splitterOpts.outputFormat),
+            archiveFormat(splitterOpts.archiveFormat),
+            writeBackend(splitterOpts.writeBackend),
             subtractAlphaFromIndex(splitterOpts.subtractAlphaSpritesFromIndex),
-            useSubFolders(splitterOpts.useSubFoldersInOutput) {}
+            useSubFolders(splitterOpts.useSubFoldersInOutput),
+            reduceColors(splitterOpts.reduceColors),
+            planOnly(splitterOpts.planOnly),
+            bundle(splitterOpts.bundle),
+            atlas(splitterOpts.atlas),
+            animate(splitterOpts.animate),
+            recompress(splitterOpts.recompress) {}
 
     // a note about using non-UTF8 strings as path name.
     // This means technically not all path names are supported,
@@ -33,10 +46,23 @@ struct IOOptions {
     // There are ways around that (obtain the encoded png bytes externally), but that is only worth doing if the need ever arises.
     std::filesystem::path inDirectory;
     std::filesystem::path outDirectory;
+    std::string fileList; // when set, the sheets to split are read from this list (see FileList), not searched for in inDirectory.
     std::set<SpriteSheetType> IOUsed; // used during splitting by SpriteSheetIO for single-folder mode, to warn about file overwrites. (e.g. double write of '0.png')
     int groundIndexOffset;
+    DeflateBackend deflateBackend; // which deflate implementation compresses saved sprites.
+    CompressionProfile compressionProfile; // how much encode time to spend on the size of saved sprites.
+    ChunkPolicy chunkPolicy; // which ancillary chunks of a sheet are copied into its sprites.
+    OutputFormat outputFormat; // with QOI, the PNG encoder options above do not apply.
+    ArchiveFormat archiveFormat; // stream the sprites of the job into one archive, instead of loose files.
+    WriteBackend writeBackend; // how loose files are written: see FileWriter.
     bool subtractAlphaFromIndex;
     bool useSubFolders;
+    bool reduceColors; // write sprites in the smallest lossless color type instead of always RGBA.
+    bool planOnly; // nothing is written, not even the output directory.
+    bool bundle; // one SpriteBundle file per sheet, named like its folder would be.
+    bool atlas; // repack all sprites of the job into a few atlases with a JSON index, instead of loose files.
+    bool animate; // one animated PNG per character, instead of a PNG per frame.
+    bool recompress; // the input is a tree of saved sprites, rewritten in place. There is no output directory.
 
     // mark an enum type as 'used' for this SpriteSheetIO run.
     // returns true if the IO was used for the first time, for this enum value, for this instance of IOOptions.
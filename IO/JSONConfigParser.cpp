@@ -31,6 +31,13 @@ struct SplitterOptsArray {
 struct SplitterOptsComplexTypeHandler {
     std::string groundFilePattern;
     int groundIndexOffset;
+    std::string deflate;
+    std::string profile;
+    std::string chunks;
+    std::string format;
+    std::string archive;
+    std::string writer;
+    std::string order;
 };
 
 /** Because the config is an array of jobs, the handler has to follow the same convention. */
@@ -50,8 +57,10 @@ void registerJSONMappings() {
 
     sm::reg(&SplitterOpts::inDirectory, "in", sm::NotEmpty{});
     sm::reg(&SplitterOpts::outDirectory, "out", sm::NotEmpty{});
+    sm::reg(&SplitterOpts::fileList, "list", sm::Default{""});
     // groundFilePattern: Cannot be mapped 1:1 from string, this is too complex for my sm::Remap.
     sm::reg(&SplitterOpts::workAmount, "cap", sm::Default{std::numeric_limits<int>::max()});
+    sm::reg(&SplitterOpts::prefetch, "prefetch", sm::Default{4});
     // isPNGInDirectory: Is not allowed to be set by JSON, this is a computed property from in directory.
     sm::reg(&SplitterOpts::recursive, "recursive", sm::Default{false});
 
@@ -59,6 +68,12 @@ void registerJSONMappings() {
     std::function<bool(const bool&)> invert = [](const bool& in) { return !in; };
     sm::reg(&SplitterOpts::useSubFoldersInOutput, "singleFolderOutput", sm::Default{true}, sm::Remap{invert});
     sm::reg(&SplitterOpts::subtractAlphaSpritesFromIndex, "subtractAlphaFromIndex", sm::Default{false});
+    sm::reg(&SplitterOpts::reduceColors, "reduceColors", sm::Default{false});
+    sm::reg(&SplitterOpts::planOnly, "plan", sm::Default{false});
+    sm::reg(&SplitterOpts::bundle, "bundle", sm::Default{false});
+    sm::reg(&SplitterOpts::atlas, "atlas", sm::Default{false});
+    sm::reg(&SplitterOpts::animate, "animate", sm::Default{false});
+    sm::reg(&SplitterOpts::recompress, "recompress", sm::Default{false});
 
     sm::reg(&SplitterOptsArray::jobs, "jobs", sm::Required{});
     sm::reg(&SplitterOptsComplexTypeHandlerArray::jobs, "jobs", sm::Required{});
@@ -66,6 +81,13 @@ void registerJSONMappings() {
     // groundFilePattern shall be handled in two steps: Extract the string, then manually insert the wrapper.
     sm::reg(&SplitterOptsComplexTypeHandler::groundFilePattern, "groundFilePattern", sm::Default{"/ground/i"});
     sm::reg(&SplitterOptsComplexTypeHandler::groundIndexOffset, "groundIndexOffset", sm::Default(-1));
+    sm::reg(&SplitterOptsComplexTypeHandler::deflate, "deflate", sm::Default{"lodepng"});
+    sm::reg(&SplitterOptsComplexTypeHandler::profile, "profile", sm::Default{"default"});
+    sm::reg(&SplitterOptsComplexTypeHandler::chunks, "chunks", sm::Default{"all"});
+    sm::reg(&SplitterOptsComplexTypeHandler::format, "format", sm::Default{"png"});
+    sm::reg(&SplitterOptsComplexTypeHandler::archive, "archive", sm::Default{"none"});
+    sm::reg(&SplitterOptsComplexTypeHandler::writer, "writer", sm::Default{"uring"});
+    sm::reg(&SplitterOptsComplexTypeHandler::order, "order", sm::Default{"path"});
 }
 
 /**
@@ -108,6 +130,27 @@ void JSONConfigParser::parseConfig(const std::string &pathToFile, std::vector<Sp
         soa.jobs[index].setIsPNGDirectory();
         int goi = socta.jobs[index].groundIndexOffset;
         soa.jobs[index].groundIndexOffset = std::make_pair(goi != -1, goi);
+        if (! deflateBackendFromString(socta.jobs[index].deflate, soa.jobs[index].deflateBackend)) {
+            throw std::logic_error("'" + socta.jobs[index].deflate + "' is not a deflate backend. Expected 'lodepng', 'fast' or 'stored'.");
+        }
+        if (! compressionProfileFromString(socta.jobs[index].profile, soa.jobs[index].compressionProfile)) {
+            throw std::logic_error("'" + socta.jobs[index].profile + "' is not a compression profile. Expected 'fast', 'default' or 'max'.");
+        }
+        if (! chunkPolicyFromString(socta.jobs[index].chunks, soa.jobs[index].chunkPolicy)) {
+            throw std::logic_error("'" + socta.jobs[index].chunks + "' is not a chunk policy. Expected 'all', 'none' or a comma separated list of chunk types.");
+        }
+        if (! outputFormatFromString(socta.jobs[index].format, soa.jobs[index].outputFormat)) {
+            throw std::logic_error("'" + socta.jobs[index].format + "' is not an output format. Expected 'png', 'qoi' or 'rgba'.");
+        }
+        if (! archiveFormatFromString(socta.jobs[index].archive, soa.jobs[index].archiveFormat)) {
+            throw std::logic_error("'" + socta.jobs[index].archive + "' is not an archive format. Expected 'none', 'tar' or 'zip'.");
+        }
+        if (! writeBackendFromString(socta.jobs[index].writer, soa.jobs[index].writeBackend)) {
+            throw std::logic_error("'" + socta.jobs[index].writer + "' is not a writer. Expected 'sync', 'pool' or 'uring'.");
+        }
+        if (! readOrderFromString(socta.jobs[index].order, soa.jobs[index].readOrder)) {
+            throw std::logic_error("'" + socta.jobs[index].order + "' is not a read order. Expected 'path', 'inode' or 'extent'.");
+        }
     }
 
     work = std::move(soa.jobs);
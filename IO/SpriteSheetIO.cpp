@@ -1,21 +1,38 @@
 #include <iostream>
+#include <fstream>
+#include <cstring>
+#include <memory>
 #include "SpriteSheetIO.h"
 #include "../logging/LoggerTags.hpp"
+#include "codec/ApngEncoder.hpp"
+#include "codec/FastDeflate.hpp"
+#include "codec/FastInflate.hpp"
+#include "codec/FastPNGDecoder.hpp"
+#include "codec/QoiCodec.hpp"
+#include "codec/SheetChunks.hpp"
+#include "codec/SpriteEncoder.hpp"
+#include "codec/Zlib.hpp"
+#include "file/FileList.hpp"
+#include "file/MappedFile.hpp"
+#include "sink/ArchiveSink.hpp"
+#include "sink/AtlasSink.hpp"
+#include "sink/BundleSink.hpp"
+#include "sink/FileSink.hpp"
+#include "sink/SpriteName.hpp"
 
 namespace logger = LoggerTags;
 
 /**
- * Validates the given IOOpts.inDirectory, and initializes the directoryIterator with this.
- * The directoryIterator pointer is always deleted, and left as nullptr if the IOOpts were invalid.
+ * Validates the given IOOpts.inDirectory, and initializes the directoryWalker with this.
+ * The directoryWalker is always reset, and left as nullptr if the IOOpts were invalid or the input is a single file.
  * @param inPath the inPath to set the in path to.
  * @param shouldBePNG whether the given path should be a .png file (or a directory if not).
  * @param recursive (only used for directory paths) whether folders within this folder are also to be considered.
  * @return whether the initialisation succeeded.
  */
-bool SpriteSheetIO::initializeDirectoryIterator(bool shouldBePNG, bool recursive) {
+bool SpriteSheetIO::initializeDirectoryWalker(bool shouldBePNG, bool recursive) {
 
-    delete directoryIterator_;
-    directoryIterator_ = nullptr;
+    directoryWalker_.reset();
 
     const fs::path& inPath = IOOpts_.inDirectory;
 
@@ -30,14 +47,15 @@ bool SpriteSheetIO::initializeDirectoryIterator(bool shouldBePNG, bool recursive
         return false;
     }
 
-    if (fs::is_directory(inPath)) {
-        if (recursive) {
-            auto *iterator = new fs::recursive_directory_iterator(inPath);
-            directoryIterator_ = new recursive_directory_iterator(iterator);
-        } else {
-            auto *iterator = new fs::directory_iterator(inPath);
-            directoryIterator_ = new directory_iterator(iterator);
-        }
+    // the paths in a list are relative to the input directory.
+    if (! IOOpts_.fileList.empty() && ! fs::is_directory(inPath)) {
+        std::cout << logger::error << "A file list was given, but the input is not a folder:\n\t\t" << inPath.string() << "\n";
+        return false;
+    }
+
+    if (fs::is_directory(inPath) && IOOpts_.fileList.empty()) {
+        // old and unfinished output, when the output directory is inside the input directory.
+        directoryWalker_ = std::make_unique<DirectoryWalker>(inPath.string(), recursive, std::vector<std::string>{TrashReaper::FOLDER_NAME, StagedOutput::FOLDER_NAME});
     }
 
     return true;
@@ -67,6 +85,10 @@ bool SpriteSheetIO::initializeOutPath() {
     // (1)
     if(! fs::exists(outFilePath)) {
         std::cout << logger::warn << "The provided output directory does not exist.\n\t\t" << outFilePath.string() << "\n";
+        if (IOOpts_.planOnly) {
+            std::cout << logger::info << "This directory would be created. (plan only)\n";
+            return true;
+        }
         std::cout << logger::warn << "This directory will be created.\n";
         std::error_code ec;
         fs::create_directory(outFilePath, ec);
@@ -105,10 +127,29 @@ bool SpriteSheetIO::initializeOutPath() {
 void SpriteSheetIO::setIOOptions(const SplitterOpts &opts) {
     IOOpts_ = IOOptions(opts);
 
-    bool directoryIteratorReady = initializeDirectoryIterator(opts.isPNGInDirectory, opts.recursive);
-    bool outPathOK = initializeOutPath();
-
-    optionsOK_ = directoryIteratorReady && outPathOK;
+    // a recompress pass rewrites the whole tree it was pointed at, in place.
+    bool directoryWalkerReady = initializeDirectoryWalker(opts.isPNGInDirectory, opts.recursive || opts.recompress);
+    bool outPathOK = opts.recompress || initializeOutPath();
+    // raw pixels have no dimensions of their own: they only make sense with the index of a bundle.
+    bool formatOK = opts.outputFormat != OutputFormat::RGBA || opts.bundle;
+    if (! formatOK) {
+        std::cout << logger::error << "The 'rgba' format can only be written into bundles. Use --bundle, or another format.\n";
+    }
+    // animations are PNG files of their own: they cannot be written as QOI, raw pixels or parts of an atlas.
+    bool animateOK = ! opts.animate || (opts.outputFormat == OutputFormat::PNG && ! opts.atlas);
+    if (! animateOK) {
+        std::cout << logger::error << "Character animations can only be written in the 'png' format, and not into atlases.\n";
+    }
+    formatOK = formatOK && animateOK;
+    bool archiveOK = directoryWalkerReady && outPathOK && formatOK && initializeArchive();
+    bool atlasOK = archiveOK && initializeAtlas();
+
+    optionsOK_ = directoryWalkerReady && outPathOK && formatOK && archiveOK && atlasOK;
+    if (! reaper_) reaper_ = std::make_unique<TrashReaper>();
+    if (optionsOK_) {
+        initializeWriter();
+        initializeStage();
+    }
 
     if (! optionsOK_) {
         std::cout << logger::error << "Something went wrong configuring the I/O. Please check the program output.\n";
@@ -118,26 +159,230 @@ void SpriteSheetIO::setIOOptions(const SplitterOpts &opts) {
 }
 
 /**
- * Creates a queue of all png files in the directory/directories represented by directoryIterator.
- * When directoryIterator is nullptr, uses only the input path instead (e.g. when infile is a .png itself)
+ * Opens the archive the sprites of this job are streamed into, if the IO options ask for one.
+ * It is named after the input folder (or file), e.g. 'in/sheets/' gives 'out/sheets.tar'.
+ *
+ * @return false if the archive could not be created, or is combined with bundles.
+ */
+bool SpriteSheetIO::initializeArchive() {
+    archive_.reset();
+    if (IOOpts_.archiveFormat == ArchiveFormat::NONE || IOOpts_.planOnly || IOOpts_.recompress) return true;
+
+    if (IOOpts_.bundle) {
+        std::cout << logger::error << "Bundles cannot be written into an archive. Use either --bundle or --archive.\n";
+        return false;
+    }
+
+    const fs::path archivePath = IOOpts_.outDirectory / (jobName() + (IOOpts_.archiveFormat == ArchiveFormat::TAR ? ".tar" : ".zip"));
+
+    archive_ = ArchiveWriter::create(IOOpts_.archiveFormat);
+    if (! archive_->open(archivePath.string())) {
+        std::cout << logger::error << "Could not create the archive " << archivePath.string() << "\n";
+        archive_.reset();
+        return false;
+    }
+    std::cout << logger::info << "Sprites are written into the archive " << archivePath.string() << "\n";
+    return true;
+}
+
+/**
+ * Sets up the atlas the sprites of this job are repacked into, if the IO options ask for one.
+ * Like the archive, the atlases and their index are named after the input folder (or file): 'out/sheets_0.png', 'out/sheets.json'.
+ *
+ * @return false if the atlas is combined with another output that replaces loose files, or with 'rgba'.
+ */
+bool SpriteSheetIO::initializeAtlas() {
+    atlas_.reset();
+    if (! IOOpts_.atlas || IOOpts_.planOnly || IOOpts_.recompress) return true;
+
+    if (IOOpts_.bundle || archive_) {
+        std::cout << logger::error << "Atlases cannot be written into bundles or archives. Use only one of --atlas, --bundle and --archive.\n";
+        return false;
+    }
+    if (IOOpts_.outputFormat == OutputFormat::RGBA) {
+        std::cout << logger::error << "The 'rgba' format cannot be used for atlases. Use 'png' or 'qoi'.\n";
+        return false;
+    }
+
+    atlas_ = std::make_unique<AtlasWriter>();
+    std::cout << logger::info << "Sprites are packed into atlases " << (IOOpts_.outDirectory / (jobName() + "_*")).string() << "\n";
+    return true;
+}
+
+/**
+ * Starts the writer of the loose files of this job, unless the IO options ask for 'sync', or the job writes no loose files.
+ * Where io_uring is unavailable, 'uring' falls back to 'pool'. That is expected (e.g. in containers that block io_uring),
+ * and it is the same for every job: it is only mentioned for the first.
+ */
+void SpriteSheetIO::initializeWriter() {
+    writer_.reset();
+    if (IOOpts_.writeBackend == WriteBackend::SYNC || IOOpts_.planOnly || IOOpts_.recompress || IOOpts_.bundle || archive_ || atlas_) return;
+
+    std::string fallbackReason;
+    writer_ = FileWriter::create(IOOpts_.writeBackend, fallbackReason);
+    if (writer_ && writer_->backend() != IOOpts_.writeBackend && !writerFallbackLogged_) {
+        std::cout << logger::info << "Cannot write with io_uring (" << fallbackReason << "), using the '" << writer_->backend() << "' writer instead.\n";
+        writerFallbackLogged_ = true;
+    }
+}
+
+/**
+ * Sets up staging for the sheet folders of this job, when it writes loose files into a folder per sheet.
+ * What an interrupted run left in the output directory, in the trash or staged, is handed to the reaper.
+ */
+void SpriteSheetIO::initializeStage() {
+    stage_.reset();
+    if (IOOpts_.planOnly || IOOpts_.recompress) return;
+
+    reaper_->reapLeftovers(IOOpts_.outDirectory / TrashReaper::FOLDER_NAME);
+    reaper_->reapLeftovers(IOOpts_.outDirectory / StagedOutput::FOLDER_NAME, StagedOutput::abandoned); // not the stages of runs still going.
+    if (IOOpts_.useSubFolders && ! IOOpts_.bundle && ! archive_ && ! atlas_) {
+        stage_ = std::make_unique<StagedOutput>(IOOpts_.outDirectory, *reaper_);
+    }
+}
+
+/**
+ * The name of the output of a job that goes into a single place, e.g. an archive: the input folder or file without extension.
+ */
+std::string SpriteSheetIO::jobName() const {
+    fs::path inPath = IOOpts_.inDirectory.lexically_normal();
+    if (! inPath.has_filename()) inPath = inPath.parent_path(); // 'sheets/'
+    std::string name = inPath.stem().string();
+    return name.empty() ? "sprites" : name;
+}
+
+/**
+ * Completes the output of a job: the end of its archive is written, or its atlases are packed and written, if there are any.
+ * If that fails, the sprites in the archive or atlases are counted as save errors instead of successes.
+ * Loose files still being written in the background are waited for, and those that failed are counted the same way.
+ * Then the staged sheet folders are swapped in, except those missing files: their sprites are counted as save errors too.
+ *
+ * @param stats stat tracking object of the job.
+ */
+void SpriteSheetIO::finishOutput(SpriteSplittingStatus& stats) {
+    if (writer_) {
+        const std::vector<FileWriter::Failure> failures = writer_->wait();
+        if (! failures.empty()) {
+            const FileWriter::Failure& first = failures.front();
+            std::cout << logger::error << "Failed to write " << failures.size() << " sprite files of this job, the first being\n\t\t"
+                      << first.path << ": " << std::strerror(first.error) << "\n";
+            const auto lost = static_cast<unsigned int>(failures.size());
+            stats.n_success -= lost;
+            stats.n_save_error += lost;
+            // failures come in about the order the files were queued: mostly in runs of the same folder.
+            for (size_t i = 0, run = 1; stage_ && i < failures.size(); i += run) {
+                for (run = 1; i + run < failures.size() && failures[i + run].folder == failures[i].folder; ++run) {}
+                stage_->failed(failures[i].folder->path(), static_cast<unsigned int>(run));
+            }
+        }
+        writer_.reset();
+    }
+
+    if (stage_) {
+        std::string error;
+        const unsigned int lost = stage_->commit(error);
+        if (lost) {
+            std::cout << logger::error << "Failed to move the sprites of this job into place, the first folder being\n\t\t" << error << "\n";
+            stats.n_success -= lost;
+            stats.n_save_error += lost;
+        }
+        stage_.reset();
+    }
+
+    if (archive_) {
+        if (! archive_->finish()) {
+            std::cout << logger::error << "Failed to write the archive of this job.\n";
+            const auto lost = static_cast<unsigned int>(archive_->entryCount());
+            stats.n_success -= lost;
+            stats.n_save_error += lost;
+        }
+        archive_.reset();
+    }
+
+    if (atlas_) {
+        // the encoder settings of a sheet, without its chunks: those of one sheet do not belong in an atlas of many.
+        SpriteSheetPNGData atlasData;
+        lodepng::State& lodeState = atlasData.lodeState;
+        configureEncoder(lodeState);
+        auto encode = [this, &lodeState](std::vector<unsigned char>& out, const unsigned char* rgba, unsigned int width, unsigned int height) {
+            return encodeAtlas(out, rgba, width, height, lodeState);
+        };
+        // two sprites of the same name would be in the atlases, and only one of them in the index.
+        std::string duplicate;
+        const bool unique = atlas_->uniqueNames(duplicate);
+        const unsigned int error = unique ? atlas_->finish(IOOpts_.outDirectory, jobName(), fileExtension(IOOpts_.outputFormat), encode) : 0;
+        if (! unique || error) {
+            if (unique) {
+                std::cout << logger::error << "Failed to write the atlases of this job.\n";
+                checkLodePNGErrorCode(error, std::cout);
+            } else {
+                std::cout << logger::error << "Not writing the atlases of this job: more than one sprite is named " << duplicate << ".\n";
+                std::cout << logger::error << "Sheets named alike up to their size (e.g. 'AObjects8x8' and 'AObjects8x8b') share a folder, and with singleFolderOutput, sheets of one type share names.\n";
+            }
+            const auto lost = static_cast<unsigned int>(atlas_->spriteCount());
+            stats.n_success -= lost;
+            stats.n_save_error += lost;
+        } else if (atlas_->spriteCount() > 0) {
+            std::cout << logger::info << "Packed " << atlas_->spriteCount() << " sprites into " << atlas_->atlasCount() << " atlases, "
+                      << static_cast<int>(atlas_->fill() * 100 + 0.5) << "% filled.\n";
+        }
+        atlas_.reset();
+    }
+}
+
+/**
+ * Lists all png files in the directory/directories represented by directoryWalker, by folder and name.
+ * When directoryWalker is nullptr, uses only the input path instead (e.g. when infile is a .png itself),
+ * or the files in the file list, in the order listed.
+ * Folders that cannot be read are reported, and left out.
  *
- * @param q the queue to fill
+ * @param pngs the list to fill
  */
-void SpriteSheetIO::fillPNGQueue(std::queue<std::string> &q) {
-    if (directoryIterator_ == nullptr) {
+void SpriteSheetIO::fillPNGList(PathArena& pngs) {
+    if (! IOOpts_.fileList.empty()) {
+        std::string error;
+        if (! FileList::read(IOOpts_.fileList, IOOpts_.inDirectory.string(), ".png", pngs, error)) {
+            std::cout << logger::error << "Could not read the list of files to split:\n\t\t" << error << "\n";
+        }
+    } else if (directoryWalker_ == nullptr) {
         if (IOOpts_.inDirectory.extension() == ".png") {
-            q.emplace(std::move(IOOpts_.inDirectory.string()));
+            pngs.addPath(IOOpts_.inDirectory.string());
         }
     } else {
-        for (auto& dirIter = *directoryIterator_ ; ! dirIter.end() ; ++dirIter) {
-            auto& dir = *dirIter;
-            if (dir.extension() == ".png") {
-                q.emplace(std::move(dirIter->string()));
-            }
+        std::vector<DirectoryWalker::Failure> failures;
+        directoryWalker_->walk(".png", pngs, failures);
+        if (! failures.empty()) {
+            std::cout << logger::warn << "Could not read " << failures.size() << " folder(s), the first being\n\t\t"
+                      << failures.front().path << ": " << std::strerror(failures.front().error) << "\n";
         }
     }
 }
 
+/**
+ * Reads only the signature and IHDR chunk of the fileName (the first 33 bytes), to learn the dimensions without a decode.
+ * Used to reject images that cannot be a SpriteSheet before committing to loadPNG.
+ *
+ * @param fileName path to the PNG.
+ * @param data receives width, height and error. The lodePNG state is inspected, loadPNG will overwrite it.
+ * @return error code from lodePNG (0 = OK)
+ */
+unsigned int SpriteSheetIO::loadPNGHeader(const std::string& fileName, SpriteSheetPNGData& data) {
+    unsigned int& error = data.error;
+    // 8 bytes signature, then the IHDR chunk: 4 length, 4 type, 13 data, 4 CRC.
+    unsigned char header[33];
+
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file) {
+        error = 78; // lodePNG: failed to open file for reading
+        return error;
+    }
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    // a file shorter than the header is reported by lodepng_inspect (error 27).
+    error = lodepng_inspect(&data.width, &data.height, &data.lodeState, header, static_cast<size_t>(file.gcount()));
+
+    return error;
+}
+
 /**
  * Using the LodePNG Library, attempts to decode the fileName as PNG.
  *
@@ -148,14 +393,140 @@ void SpriteSheetIO::fillPNGQueue(std::queue<std::string> &q) {
  */
 unsigned int SpriteSheetIO::loadPNG(const std::string& fileName, std::vector<unsigned char> &buffer, SpriteSheetPNGData& data) {
     unsigned int& error = data.error;
-    std::vector<unsigned char> encodedPixelBuffer;
 
-    error = lodepng::load_file(encodedPixelBuffer, fileName);
-    if (!error) error = lodepng::decode(buffer, data.width, data.height, data.lodeState, encodedPixelBuffer);
+    // decoded straight from the mapping: the sheet is read once, front to back.
+    MappedFile file;
+    error = file.open(fileName, MappedFile::Access::SEQUENTIAL) ? 0 : 78; // 78: lodepng's "failed to open file for reading".
+    data.fileSize = file.size();
+    if (!error) error = decodePNG(file.data(), file.size(), buffer, data);
 
     return error;
 }
 
+/**
+ * Decode PNG file contents that are already in memory. See loadPNG.
+ *
+ * @return error code from lodePNG (0 = OK)
+ */
+unsigned int SpriteSheetIO::decodePNG(const std::vector<unsigned char>& encoded, std::vector<unsigned char> &buffer, SpriteSheetPNGData& data) {
+    return decodePNG(encoded.data(), encoded.size(), buffer, data);
+}
+
+unsigned int SpriteSheetIO::decodePNG(const unsigned char* encoded, size_t size, std::vector<unsigned char> &buffer, SpriteSheetPNGData& data) {
+    // zlib container with the accelerated Adler-32 around the table driven inflate. (CRC32 is accelerated for all of lodepng, see codec/Checksum.cpp)
+    data.lodeState.decoder.zlibsettings.custom_zlib = Zlib::decompress;
+    data.lodeState.decoder.zlibsettings.custom_inflate = FastInflate::inflate;
+
+    data.error = FastPNGDecoder::decode(buffer, data.width, data.height, data.lodeState, encoded, size);
+    return data.error;
+}
+
+/**
+ * Re-encode a saved sprite with the most compression this program has: the MAX profile, and lodepng's deflate
+ * with its largest window and match settings (see Zlib::setMaxCompression). The file is only replaced if the result is smaller:
+ * it is written next to the original first, then renamed over it, so an interrupted run never leaves half a file.
+ *
+ * The zlib header of a re-encoded file says FLEVEL 3. Such files are skipped without decoding,
+ * which makes an interrupted --recompress pass cheap to restart. Files of other tools that say FLEVEL 3
+ * (e.g. zlib at -9) are skipped as well, on purpose: they were already compressed at maximum.
+ * Files that did not get smaller keep their FLEVEL, and are tried again by a later pass.
+ *
+ * Animated PNGs (see --animate) are skipped: only their default image would be re-encoded, and its
+ * frames in fdAT chunks would no longer match it once its color type is reduced.
+ *
+ * @param fileName path to the PNG.
+ * @param stats n_recompressed, n_recompress_skipped and recompress_bytes_saved are counted, and load and save errors.
+ * @param outStream stream object for printing. Can be std::cout, might be a synced stream for threading.
+ */
+void SpriteSheetIO::recompressPNG(const std::string& fileName, SpriteSplittingStatus& stats, std::basic_ostream<char>& outStream) const {
+    std::vector<unsigned char> encoded;
+    unsigned int error = lodepng::load_file(encoded, fileName);
+    if (!error && (isMaxCompressed(encoded) || isAnimated(encoded))) {
+        stats.n_recompress_skipped += 1;
+        return;
+    }
+
+    std::vector<unsigned char> pixels;
+    SpriteSheetPNGData data;
+    if (!error) error = decodePNG(encoded, pixels, data);
+    if (error) {
+        outStream << logger::threaded_error << "LodePNG decode error: " << error << " for " << fileName << "\n";
+        stats.n_load_error += 1;
+        return;
+    }
+
+    // the decoded info_png holds the color type and chunks of the file, which are written back as they are.
+    lodepng::State& lodeState = data.lodeState;
+    lodeState.encoder.zlibsettings.custom_zlib = Zlib::compress;
+    Zlib::setMaxCompression(lodeState.encoder.zlibsettings);
+
+    std::vector<unsigned char> recompressed;
+    error = SpriteEncoder::encode(recompressed, pixels.data(), data.width, data.height, lodeState, CompressionProfile::MAX, IOOpts_.reduceColors);
+    if (error) {
+        checkLodePNGErrorCode(error, outStream);
+        stats.n_save_error += 1;
+        return;
+    }
+    if (recompressed.size() >= encoded.size()) {
+        stats.n_recompress_skipped += 1;
+        return;
+    }
+
+    const std::string temporaryName = fileName + ".tmp";
+    std::error_code ec;
+    error = lodepng::save_file(recompressed, temporaryName);
+    if (!error) fs::rename(temporaryName, fileName, ec);
+    if (error || ec.value() != 0) {
+        outStream << logger::threaded_error << "Could not replace " << fileName << "\n";
+        fs::remove(temporaryName, ec);
+        stats.n_save_error += 1;
+        return;
+    }
+
+    stats.n_recompressed += 1;
+    stats.recompress_bytes_saved += encoded.size() - recompressed.size();
+}
+
+// static
+SpriteBundle::Payload SpriteSheetIO::bundlePayload(OutputFormat format) {
+    switch (format) {
+        case OutputFormat::QOI:
+            return SpriteBundle::Payload::QOI;
+        case OutputFormat::RGBA:
+            return SpriteBundle::Payload::RGBA;
+        case OutputFormat::PNG:
+        default:
+            return SpriteBundle::Payload::PNG;
+    }
+}
+
+/**
+ * Whether the first IDAT of a PNG file starts with a zlib header that says FLEVEL 3. Only the chunk headers are read.
+ */
+bool SpriteSheetIO::isMaxCompressed(const std::vector<unsigned char>& png) {
+    if (png.size() < 8) return false;
+    const unsigned char* end = png.data() + png.size();
+    for (const unsigned char* chunk = png.data() + 8; chunk + 12 <= end; chunk = lodepng_chunk_next_const(chunk, end)) {
+        if (lodepng_chunk_type_equals(chunk, "IDAT")) {
+            return lodepng_chunk_length(chunk) >= 2 && chunk + 10 <= end && Zlib::level(lodepng_chunk_data_const(chunk)) == Zlib::LEVEL_MAX;
+        }
+    }
+    return false;
+}
+
+/**
+ * Whether a PNG file has an acTL chunk. It comes before the first IDAT, so only the chunks up to that are looked at.
+ */
+bool SpriteSheetIO::isAnimated(const std::vector<unsigned char>& png) {
+    if (png.size() < 8) return false;
+    const unsigned char* end = png.data() + png.size();
+    for (const unsigned char* chunk = png.data() + 8; chunk + 12 <= end; chunk = lodepng_chunk_next_const(chunk, end)) {
+        if (lodepng_chunk_type_equals(chunk, "acTL")) return true;
+        if (lodepng_chunk_type_equals(chunk, "IDAT")) return false;
+    }
+    return false;
+}
+
 /**
  * Generic entry point for saving a type of splits. Calls the correct saving method depending on the given SpriteSheetType inside the SpriteSplittingData struct.
  *
@@ -165,10 +536,47 @@ unsigned int SpriteSheetIO::loadPNG(const std::string& fileName, std::vector<uns
 void SpriteSheetIO::saveSplits(SpriteSplittingData& ssd, std::basic_ostream<char>& outStream) {
 
     std::string folderName = folderNameFromSheetName(ssd.originalFileName, ssd.sheetType);
-    std::error_code ec;
-    bool cleanedFolder = createCleanDirectory(folderName, ec);
-    if (! cleanedFolder || ec.value() != 0) {
-        outStream << logger::threaded_error << "Failed to create folder " << folderName << "\n\t\t" << ec << "\n";
+    std::unique_ptr<SpriteSink> sink;
+    StagedOutput::Stage* stage = nullptr;
+    if (IOOpts_.bundle) { // one file next to where the folder would be.
+        sink = std::make_unique<BundleSink>(IOOpts_.outDirectory / (folderName + SpriteBundle::EXTENSION), bundlePayload(IOOpts_.outputFormat));
+    } else if (archive_) { // the paths the files would have on disk, relative to the output directory.
+        sink = std::make_unique<ArchiveSink>(*archive_, IOOpts_.useSubFolders ? folderName + '/' : std::string(), fileExtension(IOOpts_.outputFormat));
+    } else if (atlas_) { // named by those same paths in the atlas index.
+        sink = std::make_unique<AtlasSink>(*atlas_, atlasPrefix(ssd.originalFileName, folderName), fileExtension(IOOpts_.outputFormat));
+    } else {
+        // a folder of its own is staged, and replaces the folder of an earlier run at the end of the job.
+        // The shared folder is written to as it is: it also holds the sprites of other sheets.
+        fs::path folderPath = outputFolder(ssd.originalFileName, ssd.sheetType);
+        if (stage_) {
+            std::error_code ec;
+            stage = stage_->stage(folderName, ec);
+            if (! stage) {
+                outStream << logger::threaded_error << "Failed to create folder " << folderName << "\n\t\t" << ec << "\n";
+                ssd.stats.n_save_error += ssd.spriteCount; // mark every sprite as failed.
+                return;
+            }
+            folderPath = stage->staged;
+        }
+        // opened once: the sprites are created in it by name.
+        int openError;
+        std::shared_ptr<const OutputFolder> folder = OutputFolder::open(folderPath.string(), openError);
+        if (! folder) {
+            outStream << logger::threaded_error << "Failed to open folder " << folderName << "\n\t\t" << std::strerror(openError) << "\n";
+            ssd.stats.n_save_error += ssd.spriteCount; // mark every sprite as failed.
+            return;
+        }
+        sink = std::make_unique<FileSink>(std::move(folder), fileExtension(IOOpts_.outputFormat), writer_.get());
+    }
+
+    configureEncoder(ssd.lodeState);
+
+    SheetChunks::Savings chunkSavings {};
+    // QOI has no chunks, and atlases mix sheets: there is nothing to prepare, and nothing to count as saved.
+    unsigned int chunkError = IOOpts_.outputFormat == OutputFormat::PNG && !atlas_ ? SheetChunks::prepare(ssd.lodeState, ssd.spriteSheet, IOOpts_.chunkPolicy, chunkSavings) : 0;
+    if (chunkError) {
+        outStream << logger::threaded_error << "Failed to prepare the chunks of " << ssd.originalFileName << "\n";
+        checkLodePNGErrorCode(chunkError, outStream);
         ssd.stats.n_save_error += ssd.spriteCount; // mark every sprite as failed.
         return;
     }
@@ -179,7 +587,7 @@ void SpriteSheetIO::saveSplits(SpriteSplittingData& ssd, std::basic_ostream<char
     // saveGroundSplits inserts an index offset to avoid collision, if in single-folder-mode.
     // Hence, this overwriting issue really is only relevant if you re-use the same sheet type without subfolders.
     bool firstTimeUse = IOOpts_.useIO(ssd.sheetType);
-    bool saveProblem = !(IOOpts_.useSubFolders || firstTimeUse);
+    bool saveProblem = !(IOOpts_.useSubFolders || IOOpts_.bundle || firstTimeUse);
     if (saveProblem) {
         outStream << logger::threaded_warn << "A sheet of type " << ssd.sheetType << " is about to be saved,\n";
         outStream << logger::threaded_warn << "however, this will overwrite files that already exist.\n";
@@ -187,16 +595,17 @@ void SpriteSheetIO::saveSplits(SpriteSplittingData& ssd, std::basic_ostream<char
         outStream << logger::threaded_warn << "The latter option may have a noticeable performance impact.\n";
     }
 
-    unsigned int oldSavedSprites = ssd.stats.n_success; // used if saveProblem == true.
+    unsigned int oldSavedSprites = ssd.stats.n_success; // to count the sprites of this sheet, after saving.
+    unsigned int oldSaveErrors = ssd.stats.n_save_error;
     switch (ssd.sheetType) {
         case SpriteSheetType::OBJECT:
-            saveObjectSplits(ssd, folderName, outStream);
+            saveObjectSplits(ssd, *sink, outStream);
             break;
         case SpriteSheetType::CHARACTER:
-            saveCharSplits(ssd, folderName, outStream);
+            saveCharSplits(ssd, *sink, outStream);
             break;
         case SpriteSheetType::GROUND:
-            saveGroundSplits(ssd, folderName, outStream);
+            saveGroundSplits(ssd, *sink, outStream);
             break;
         default: // did you add a new SpriteSheetType?
             // easiest way to get the thread number in the exception, performance doesn't matter at this point we're crashing.
@@ -205,13 +614,129 @@ void SpriteSheetIO::saveSplits(SpriteSplittingData& ssd, std::basic_ostream<char
             throw std::logic_error(ss.str());
     }
 
+    unsigned int writtenSprites = ssd.stats.n_success - oldSavedSprites;
+    unsigned int finishError = sink->finish();
+    if (finishError) {
+        outStream << logger::threaded_error << "Failed to write the sprites of " << ssd.originalFileName << "\n";
+        checkLodePNGErrorCode(finishError, outStream);
+        ssd.stats.n_success -= writtenSprites;
+        ssd.stats.n_save_error += writtenSprites;
+        return;
+    }
+    if (stage && ssd.stats.n_save_error != oldSaveErrors) {
+        // an incomplete folder does not replace the folder of an earlier run: the unsealed stage is deleted, with its sprites.
+        outStream << logger::threaded_error << "Not replacing the folder of " << ssd.originalFileName << ", as not all its sprites were saved\n";
+        ssd.stats.n_success -= writtenSprites;
+        ssd.stats.n_save_error += writtenSprites;
+        return;
+    }
+    if (stage) stage_->seal(stage, writtenSprites);
+    ssd.stats.chunk_bytes_saved += static_cast<unsigned long long>(chunkSavings.droppedBytes) * writtenSprites;
+    // the chunks were serialized once, where before every sprite did so.
+    if (writtenSprites > 0) ssd.stats.chunk_seconds_saved += chunkSavings.serializeSeconds * (writtenSprites - 1);
+
     if (saveProblem) { // we just overwrote some files. What's the damage?
-        unsigned int newSavedSprites = ssd.stats.n_success;
-        unsigned int written = newSavedSprites - oldSavedSprites;
         // count all of these as errors. Note that not necessarily all these files were overwritten.
         // If the previous sheet of the same type had 10 sprites, and this one has 12 sprites, there are 10 overwrites not 12.
-        ssd.stats.n_save_error += written;
+        ssd.stats.n_save_error += writtenSprites;
+    }
+}
+
+/**
+ * The folder that saveSplits writes the sprites of a sheet to.
+ *
+ * @param sheetPath path to the SpriteSheet.
+ * @param type type of the SpriteSheet.
+ * @return a sub folder of the output directory named after the sheet, or the output directory itself in single-folder mode.
+ */
+fs::path SpriteSheetIO::outputFolder(const std::string& sheetPath, const SpriteSheetType& type) const {
+    if (IOOpts_.useSubFolders) {
+        return IOOpts_.outDirectory / folderNameFromSheetName(sheetPath, type);
     }
+    return IOOpts_.outDirectory;
+}
+
+/**
+ * The prefix of the names of a sheet's sprites in the atlas index: the folder of the sheet, relative to the input folder,
+ * followed by the folder the sprites would have had as loose files. Sheets with the same name in different folders
+ * (recursive, or in a file list) share that second folder, and would otherwise give their sprites the same names.
+ *
+ * @param sheetPath path to the SpriteSheet.
+ * @param folderName the name of its sub folder in the output directory.
+ * @return the prefix, with a trailing '/', or empty for a sheet in the input folder itself in single-folder mode.
+ */
+std::string SpriteSheetIO::atlasPrefix(const std::string& sheetPath, const std::string& folderName) const {
+    const fs::path base = IOOpts_.inDirectory.extension() == ".png" ? IOOpts_.inDirectory.parent_path() : IOOpts_.inDirectory;
+    const fs::path folder = fs::path(sheetPath).parent_path();
+    fs::path relative = folder.lexically_relative(base);
+    if (relative.empty()) relative = folder; // no way there from the input folder, e.g. an absolute path in a file list.
+
+    std::string prefix = relative == "." ? std::string() : relative.generic_string() + '/';
+    if (IOOpts_.useSubFolders) prefix += folderName + '/';
+    return prefix;
+}
+
+/**
+ * Apply the encoder related IO options to the LodePNG state that will encode the sprites of one sheet.
+ *
+ * @param lodeState the LodePNG State of the sheet about to be saved.
+ */
+void SpriteSheetIO::configureEncoder(lodepng::State& lodeState) const {
+    LodePNGCompressSettings& zlibSettings = lodeState.encoder.zlibsettings;
+    zlibSettings.custom_zlib = Zlib::compress; // delegates to custom_deflate, set below.
+    switch (IOOpts_.deflateBackend) {
+        case DeflateBackend::LODEPNG:
+            zlibSettings.custom_deflate = nullptr;
+            break;
+        case DeflateBackend::FAST:
+            zlibSettings.custom_deflate = FastDeflate::deflate;
+            break;
+        case DeflateBackend::STORED:
+            zlibSettings.custom_deflate = nullptr;
+            zlibSettings.btype = 0; // lodepng writes stored blocks.
+            break;
+    }
+}
+
+/**
+ * Encode one sprite in the output format of the IO options.
+ *
+ * @param out receives the file contents.
+ * @param sprite RGBA pixels of the sprite.
+ * @param lodeState the LodePNG State of the sheet, configured by configureEncoder. Not used for QOI.
+ * @return error code from lodePNG (0 = OK). QOI can only fail the SPLITTER_VERIFY_CODECS check, as error 1.
+ */
+unsigned int SpriteSheetIO::encodeSprite(std::vector<unsigned char>& out, const unsigned char* sprite, unsigned int width, unsigned int height, lodepng::State& lodeState) const {
+    switch (IOOpts_.outputFormat) {
+        case OutputFormat::QOI:
+            return QoiCodec::encode(out, sprite, width, height);
+        case OutputFormat::RGBA: // the sink takes the pixels as they are.
+            out.clear();
+            return 0;
+        case OutputFormat::PNG:
+        default:
+            return SpriteEncoder::encode(out, sprite, width, height, lodeState, IOOpts_.compressionProfile, IOOpts_.reduceColors);
+    }
+}
+
+/**
+ * Encode an atlas in the output format of the IO options. For PNG, two settings differ from sprites:
+ * - the deflate window spans a full row of the atlas (up to the 32K deflate allows), so the row above can be matched.
+ *   The default window of 2048 bytes is only 512 pixels: on the measured atlases, that was a third larger.
+ * - the default profile writes filter 0. It decides on the colors of the whole image, which for an atlas are many,
+ *   while the pixel art in it compresses better unfiltered (40% on the measured atlases). 'max' still tries both.
+ *
+ * @param lodeState a LodePNG State configured by configureEncoder. Its window size is overwritten.
+ * @return error code from lodePNG (0 = OK).
+ */
+unsigned int SpriteSheetIO::encodeAtlas(std::vector<unsigned char>& out, const unsigned char* atlas, unsigned int width, unsigned int height, lodepng::State& lodeState) const {
+    if (IOOpts_.outputFormat != OutputFormat::PNG) return encodeSprite(out, atlas, width, height, lodeState);
+
+    unsigned int window = 2048; // lodepng's default.
+    while (window < width * 4 && window < 32768) window *= 2;
+    lodeState.encoder.zlibsettings.windowsize = window;
+    const CompressionProfile profile = IOOpts_.compressionProfile == CompressionProfile::DEFAULT ? CompressionProfile::FAST : IOOpts_.compressionProfile;
+    return SpriteEncoder::encode(out, atlas, width, height, lodeState, profile, IOOpts_.reduceColors);
 }
 
 /**
@@ -230,7 +755,7 @@ void SpriteSheetIO::saveSplits(SpriteSplittingData& ssd, std::basic_ostream<char
  *            originalFileName: name of the SpriteSheet the splits originate from
  *            stats: stat tracking object
  */
-void SpriteSheetIO::saveObjectSplits(SpriteSplittingData &ssd, const std::string &folderName, std::basic_ostream<char>& outStream) const {
+void SpriteSheetIO::saveObjectSplits(SpriteSplittingData &ssd, SpriteSink& sink, std::basic_ostream<char>& outStream) const {
 
     auto* sprite = new unsigned char[ssd.spriteSize * ssd.spriteSize * 4];
     int skippedSprites = 0;
@@ -253,7 +778,7 @@ void SpriteSheetIO::saveObjectSplits(SpriteSplittingData &ssd, const std::string
         } else {
             // subtract from the index the amount of alpha sprites we ignored, if this indexing method is user specified.
             int index = i - (IOOpts_.subtractAlphaFromIndex ? skippedSprites : 0);
-            bool error = saveObjectSprite(sprite, index, ssd.spriteSize, ssd.lodeState, folderName, outStream);
+            bool error = saveObjectSprite(sprite, index, ssd.spriteSize, ssd.lodeState, sink, outStream);
             ssd.stats.n_save_error +=   error;
             ssd.stats.n_success +=      ! error;
         }
@@ -265,31 +790,24 @@ void SpriteSheetIO::saveObjectSplits(SpriteSplittingData &ssd, const std::string
 }
 
 /**
- * Encodes and saves the byte data of a single sprite to disk as png.
+ * Encodes and saves the byte data of a single sprite to disk, as png or in the output format of the IO options.
  *
  * @param sprite the byte data
- * @param index used for naming: index 0 would be called '0.png'.
+ * @param index used for naming: index 0 would be called '0.png' (or '0.qoi').
  * @param spriteSize the size of the sprite
  * @param lodeState the LodePNG library encoder/decoder State.
- * @param folderName the name of the folder this should go into. An absolute path (using outFilePath_ and index) is generated.
+ * @param sink where the sprite goes: a file in the folder of the sheet, a bundle, an archive or an atlas.
  *
  * @return whether an error ocurred.
  */
-bool SpriteSheetIO::saveObjectSprite(const unsigned char* sprite, int index, unsigned int spriteSize, lodepng::State& lodeState, const std::string& folderName, std::basic_ostream<char>& outStream) const {
+bool SpriteSheetIO::saveObjectSprite(const unsigned char* sprite, int index, unsigned int spriteSize, lodepng::State& lodeState, SpriteSink& sink, std::basic_ostream<char>& outStream) const {
     unsigned int error;
-    std::string fileName = std::to_string(index) + ".png";
     std::vector<unsigned char> encodedPixels;
 
-    error = lodepng::encode(encodedPixels, sprite, spriteSize, spriteSize, lodeState);
+    error = sink.needsEncoding() ? encodeSprite(encodedPixels, sprite, spriteSize, spriteSize, lodeState) : 0;
     checkLodePNGErrorCode(error, outStream);
     if (!error) {
-        std::filesystem::path outPath = IOOpts_.outDirectory;
-        if (IOOpts_.useSubFolders) { // insert a subfolder in the directory if specified by options.
-            outPath /= folderName;
-        }
-        outPath /= fileName;
-        // as per lodepng documentation, save_file overwrites files without warning. There is no alternative in the library.
-        error = lodepng::save_file(encodedPixels, outPath.string());
+        error = sink.put(SpriteName(index).view(), sprite, spriteSize, spriteSize, std::move(encodedPixels));
         checkLodePNGErrorCode(error, outStream);
     }
 
@@ -314,7 +832,7 @@ bool SpriteSheetIO::saveObjectSprite(const unsigned char* sprite, int index, uns
  *            originalFileName: name of the SpriteSheet the splits originate from
  *            stats: stat tracking object
  */
-void SpriteSheetIO::saveGroundSplits(SpriteSplittingData &ssd, const std::string &folderName, std::basic_ostream<char>& outStream) const {
+void SpriteSheetIO::saveGroundSplits(SpriteSplittingData &ssd, SpriteSink& sink, std::basic_ostream<char>& outStream) const {
     //                                                           + pixels for the apron (4x edge + corners), 4 bytes per pixel), The Exalt Special
     size_t bytes_per_sprite = ssd.spriteSize * ssd.spriteSize * 4 + (((ssd.spriteSize * 4) + 4) * 4);
     auto* sprite = new unsigned char[bytes_per_sprite];
@@ -364,7 +882,7 @@ void SpriteSheetIO::saveGroundSplits(SpriteSplittingData &ssd, const std::string
             index += IOOpts_.groundIndexOffset;
             // NOTE: We call 'saveObjectSprite' intentionally. The method of saving is indistinguishable from objects (The Exalt Special).
             // We only need to take care to expand the spriteSize parameter for The Exalt Special. The square of this number is used by lodepng.
-            bool error = saveObjectSprite(sprite, index, ssd.spriteSize + 2, ssd.lodeState, folderName, outStream);
+            bool error = saveObjectSprite(sprite, index, ssd.spriteSize + 2, ssd.lodeState, sink, outStream);
             ssd.stats.n_save_error +=   error;
             ssd.stats.n_success +=      ! error;
         }
@@ -389,7 +907,7 @@ void SpriteSheetIO::saveGroundSplits(SpriteSplittingData &ssd, const std::string
  *            stats: stat tracking object
  *
  */
-void SpriteSheetIO::saveCharSplits(SpriteSplittingData& ssd, const std::string& folderName, std::basic_ostream<char>& outStream) const {
+void SpriteSheetIO::saveCharSplits(SpriteSplittingData& ssd, SpriteSink& sink, std::basic_ostream<char>& outStream) const {
     // for char sheets, one row = one character. If there exists invisible frames on that row (but not all are invisible),
     // then that is perfectly valid. For example, pet skins without attack frames.
     // I suspect Exalt still expects full alpha frames to slot into e.g. a pets attack frames.
@@ -421,7 +939,9 @@ void SpriteSheetIO::saveCharSplits(SpriteSplittingData& ssd, const std::string&
                 // subtract from the index the amount of alpha sprites we ignored, if this indexing method is user specified.
                 int index = (i / SPRITES_PER_CHAR) - (IOOpts_.subtractAlphaFromIndex ? skippedSprites : 0);
                 // unsigned char** charSprites is now holding a chars' sprites. Finally!
-                unsigned int errors = saveCharSprites(charSprites, index, ssd.spriteSize, ssd.lodeState, folderName, outStream);
+                unsigned int errors = IOOpts_.animate
+                        ? saveCharAnimation(charSprites, index, ssd.spriteSize, ssd.lodeState, sink, outStream)
+                        : saveCharSprites(charSprites, index, ssd.spriteSize, ssd.lodeState, sink, outStream);
                 ssd.stats.n_save_error += errors;
                 ssd.stats.n_success += static_cast<unsigned int>(SPRITES_PER_CHAR) - errors;
             }
@@ -443,35 +963,26 @@ void SpriteSheetIO::saveCharSplits(SpriteSplittingData& ssd, const std::string&
  * @param index Used for naming. e.g. index 3 is called 3_[character_frame_name].png
  * @param spriteSize size of the (base) sprite
  * @param lodeState LodePNG Library encoder/decoder state
- * @param folderName the name of the folder this should go into. The folder is assumed to exist.
- * @param jobStats tracking object for sprite splitting stats
+ * @param sink where the sprites go: files in the folder of the sheet, a bundle, an archive or an atlas.
  *
  * @return number of errors that occurred.
  */
-unsigned int SpriteSheetIO::saveCharSprites(unsigned char *sprites [SPRITES_PER_CHAR], int index, unsigned int spriteSize, lodepng::State &lodeState, const std::string &folderName, std::basic_ostream<char>& outStream) const {
+unsigned int SpriteSheetIO::saveCharSprites(unsigned char *sprites [SPRITES_PER_CHAR], int index, unsigned int spriteSize, lodepng::State &lodeState, SpriteSink& sink, std::basic_ostream<char>& outStream) const {
     unsigned int error;
     unsigned int errorCount = 0;
-    std::string baseFileName = std::to_string(index) + '_';
+    SpriteName name(index); // index_descriptor.png format needed
 
     for (const auto& kvp : CHAR_SHEET_TYPE_TO_NAME) {
 
         int spriteIndex = to_integral(kvp.first);
         unsigned int width = spriteIndex == CharSheetInfo::ATTACK_2 ? (2 * spriteSize) : spriteSize; // attack2 is twice as wide!
 
-        std::string fileName = baseFileName + kvp.second + ".png"; // index_descriptor.png format needed
-
         std::vector<unsigned char> encodedPixels;
-        error = lodepng::encode(encodedPixels, sprites[spriteIndex], width, spriteSize, lodeState);
+        error = sink.needsEncoding() ? encodeSprite(encodedPixels, sprites[spriteIndex], width, spriteSize, lodeState) : 0;
         checkLodePNGErrorCode(error, outStream);
 
         if (!error) {
-            std::filesystem::path outPath = IOOpts_.outDirectory;
-            if (IOOpts_.useSubFolders) { // insert a subfolder in the directory if specified by options.
-                outPath /= folderName;
-            }
-            outPath /= fileName;
-            // as per lodepng documentation, save_file overwrites files without warning. There is no alternative in the library.
-            error = lodepng::save_file(encodedPixels, outPath.string());
+            error = sink.put(name.withSuffix(kvp.second), sprites[spriteIndex], width, spriteSize, std::move(encodedPixels));
             checkLodePNGErrorCode(error, outStream);
         }
 
@@ -481,6 +992,46 @@ unsigned int SpriteSheetIO::saveCharSprites(unsigned char *sprites [SPRITES_PER_
     return errorCount;
 }
 
+/**
+ * Encodes and saves a single characters sprites as one animated PNG, named e.g. 3_Right_Animation.png,
+ * with the frames in sheet order: idle, walk, walk, attack, attack.
+ *
+ * The canvas is as wide as the wide attack frame. The first frame is the default image, which has to cover the canvas:
+ * it is the idle frame with transparent pixels to its right. The other frames are placed at the left edge, as they are.
+ *
+ * @param sprites the sprites belonging to this character
+ * @param index Used for naming.
+ * @param spriteSize size of the (base) sprite
+ * @param lodeState LodePNG Library encoder/decoder state
+ * @param sink where the animation goes.
+ *
+ * @return number of sprites that could not be saved: all of them, or none.
+ */
+unsigned int SpriteSheetIO::saveCharAnimation(unsigned char* sprites [SPRITES_PER_CHAR], int index, unsigned int spriteSize, lodepng::State& lodeState, SpriteSink& sink, std::basic_ostream<char>& outStream) const {
+    const unsigned int canvasWidth = 2 * spriteSize;
+    std::vector<unsigned char> canvas(static_cast<size_t>(canvasWidth) * spriteSize * 4, 0);
+    for (unsigned int row = 0; row < spriteSize; ++row) {
+        memcpy(canvas.data() + row * canvasWidth * 4, sprites[to_integral(CharSheetInfo::IDLE)] + row * spriteSize * 4, spriteSize * 4);
+    }
+
+    std::vector<ApngEncoder::Frame> frames;
+    frames.push_back({{canvas.data(), canvasWidth, spriteSize}, 0, 0});
+    for (int i = to_integral(CharSheetInfo::WALK_1); i < SPRITES_PER_CHAR; ++i) {
+        const unsigned int width = i == CharSheetInfo::ATTACK_2 ? canvasWidth : spriteSize; // attack2 is twice as wide!
+        frames.push_back({{sprites[i], width, spriteSize}, 0, 0});
+    }
+
+    std::vector<unsigned char> encodedPixels;
+    unsigned int error = ApngEncoder::encode(encodedPixels, frames, CHAR_FRAME_DELAY_MS, lodeState, IOOpts_.compressionProfile, IOOpts_.reduceColors);
+    checkLodePNGErrorCode(error, outStream);
+    if (!error) {
+        error = sink.put(SpriteName(index).withSuffix(CHAR_ANIMATION_NAME), canvas.data(), canvasWidth, spriteSize, std::move(encodedPixels));
+        checkLodePNGErrorCode(error, outStream);
+    }
+
+    return error ? static_cast<unsigned int>(SPRITES_PER_CHAR) : 0;
+}
+
 /**
  * Checks if a set of sprites belonging to a character is fully alpha.
  * @param sprites the collection of sprites.
@@ -583,34 +1134,6 @@ std::string SpriteSheetIO::folderNameFromSheetName(const std::string &sheetPath,
     }
 }
 
-/**
- * Cleans out or creates the directory given by appending the given dir to the outFilePath_
- *
- * Depending on the useSubFolders option, either the subdirectory is cleaned, or nothing is done at all:
- * If a shared folder for multiple sheets gets cleaned, one file's splits would be saved,
- * only for a future split to empty this folder again and put its splits in.
- *
- * @param dir the folder(s) to append to outFilePath
- * @return whether the operation was successful
- */
-bool SpriteSheetIO::createCleanDirectory(const std::string& dir, std::error_code& ec) const noexcept {
-     if (IOOpts_.useSubFolders) {
-        if (fs::exists(IOOpts_.outDirectory / dir)) {
-            fs::remove_all(IOOpts_.outDirectory / dir, ec);
-        }
-
-        if (ec.value() != 0) return false;
-
-        return fs::create_directory(IOOpts_.outDirectory / dir, ec);
-     } else { // shared folder case, do not delete other threads' work!!
-         return true;
-     }
-}
-
-SpriteSheetIO::~SpriteSheetIO() {
-    delete directoryIterator_;
-}
-
 // Print an error, if and only if the lodePNG error code returned is non-zero.
 void SpriteSheetIO::checkLodePNGErrorCode(unsigned int lode_code, std::basic_ostream<char>& outStream) {
     if (lode_code) outStream << logger::error << "LodePNG error: " << lodepng_error_text(lode_code) << ".\n";
@@ -2,7 +2,6 @@
 #define SPRITESHEETSPLITTER_SPRITESHEETIO_H
 
 #include <filesystem>
-#include <queue>
 #include <map>
 #include "lodepng.h"
 #include "../util/SpriteSheetPNGData.h"
@@ -11,81 +10,67 @@
 #include "../util/SpriteSplittingStatus.h"
 #include "../util/SpriteSplittingData.h"
 #include "IOOptions.hpp"
+#include "archive/ArchiveWriter.hpp"
+#include "atlas/AtlasWriter.hpp"
+#include "bundle/SpriteBundle.hpp"
+#include "file/DirectoryWalker.hpp"
+#include "file/FileWriter.hpp"
+#include "file/PathArena.hpp"
+#include "file/StagedOutput.hpp"
+#include "file/TrashReaper.hpp"
+#include "sink/SpriteSink.hpp"
 
 namespace fs = std::filesystem;
 
-class ignorant_directory_iterator;
-
 class SpriteSheetIO {
 public:
     SpriteSheetIO() = default;
-    ~SpriteSheetIO();
     void setIOOptions(const SplitterOpts &opts);
-    void fillPNGQueue(std::queue<std::string>& q);
+    void fillPNGList(PathArena& pngs);
+    static unsigned int loadPNGHeader(const std::string& fileName, SpriteSheetPNGData& data);
     static unsigned int loadPNG(const std::string& fileName, std::vector<unsigned char> &buffer, SpriteSheetPNGData& data);
+    static unsigned int decodePNG(const std::vector<unsigned char>& encoded, std::vector<unsigned char> &buffer, SpriteSheetPNGData& data);
+    static unsigned int decodePNG(const unsigned char* encoded, size_t size, std::vector<unsigned char> &buffer, SpriteSheetPNGData& data);
+    void recompressPNG(const std::string& fileName, SpriteSplittingStatus& stats, std::basic_ostream<char>& outStream) const;
     void saveSplits(SpriteSplittingData& ssd, std::basic_ostream<char>& outStream);
+    void finishOutput(SpriteSplittingStatus& stats);
+    [[nodiscard]] fs::path outputFolder(const std::string& sheetPath, const SpriteSheetType& type) const;
     [[nodiscard]] inline bool validOptions() const { return optionsOK_; }
 
 private:
     IOOptions IOOpts_;
-    ignorant_directory_iterator* directoryIterator_ = nullptr;
+    std::unique_ptr<DirectoryWalker> directoryWalker_; // finds the sheets of a folder, nullptr when the input is a single file.
+    std::unique_ptr<ArchiveWriter> archive_; // the archive of the current job, if any. Shared by all threads.
+    std::unique_ptr<AtlasWriter> atlas_; // the atlases of the current job, if any. Shared by all threads.
+    std::unique_ptr<FileWriter> writer_; // writes the loose files of the current job in the background, if any. Shared by all threads.
+    bool writerFallbackLogged_ = false;
+    std::unique_ptr<TrashReaper> reaper_; // deletes old output folders in the background, across jobs. Shared by all threads.
+    std::unique_ptr<StagedOutput> stage_; // the sheet folders of the current job, until they are swapped in, if any. Shared by all threads.
     bool optionsOK_ = false; // is written to by setIOOptions.
 
-    [[nodiscard]] bool initializeDirectoryIterator(bool shouldBePNG, bool recursive);
+    [[nodiscard]] bool initializeDirectoryWalker(bool shouldBePNG, bool recursive);
     [[nodiscard]] bool initializeOutPath();
-    [[nodiscard]] bool createCleanDirectory(const std::string& dir, std::error_code& ec) const noexcept;
-    void saveObjectSplits(SpriteSplittingData &ssd, const std::string &folderName, std::basic_ostream<char>& outStream) const;
-    void saveCharSplits(SpriteSplittingData& ssd, const std::string& folderName, std::basic_ostream<char>& outStream) const;
-    void saveGroundSplits(SpriteSplittingData& ssd, const std::string& folderName, std::basic_ostream<char>& outStream) const;
-    bool saveObjectSprite(const unsigned char* sprite, int index, unsigned int spriteSize, lodepng::State& lodeState, const std::string& folderName, std::basic_ostream<char>& outStream) const;
-    unsigned int saveCharSprites(unsigned char* sprites [SPRITES_PER_CHAR], int index, unsigned int spriteSize, lodepng::State& lodeState, const std::string& folderName, std::basic_ostream<char>& outStream) const;
+    [[nodiscard]] bool initializeArchive();
+    [[nodiscard]] bool initializeAtlas();
+    void initializeWriter();
+    void initializeStage();
+    [[nodiscard]] std::string jobName() const;
+    [[nodiscard]] std::string atlasPrefix(const std::string& sheetPath, const std::string& folderName) const;
+    void configureEncoder(lodepng::State& lodeState) const;
+    void saveObjectSplits(SpriteSplittingData &ssd, SpriteSink& sink, std::basic_ostream<char>& outStream) const;
+    void saveCharSplits(SpriteSplittingData& ssd, SpriteSink& sink, std::basic_ostream<char>& outStream) const;
+    void saveGroundSplits(SpriteSplittingData& ssd, SpriteSink& sink, std::basic_ostream<char>& outStream) const;
+    unsigned int encodeSprite(std::vector<unsigned char>& out, const unsigned char* sprite, unsigned int width, unsigned int height, lodepng::State& lodeState) const;
+    unsigned int encodeAtlas(std::vector<unsigned char>& out, const unsigned char* atlas, unsigned int width, unsigned int height, lodepng::State& lodeState) const;
+    bool saveObjectSprite(const unsigned char* sprite, int index, unsigned int spriteSize, lodepng::State& lodeState, SpriteSink& sink, std::basic_ostream<char>& outStream) const;
+    unsigned int saveCharAnimation(unsigned char* sprites [SPRITES_PER_CHAR], int index, unsigned int spriteSize, lodepng::State& lodeState, SpriteSink& sink, std::basic_ostream<char>& outStream) const;
+    unsigned int saveCharSprites(unsigned char* sprites [SPRITES_PER_CHAR], int index, unsigned int spriteSize, lodepng::State& lodeState, SpriteSink& sink, std::basic_ostream<char>& outStream) const;
     static void checkLodePNGErrorCode(unsigned int code, std::basic_ostream<char>& outStream);
+    static SpriteBundle::Payload bundlePayload(OutputFormat format);
+    static bool isMaxCompressed(const std::vector<unsigned char>& png);
+    static bool isAnimated(const std::vector<unsigned char>& png);
     static bool charSpritesAreAlpha(unsigned char* sprites [SPRITES_PER_CHAR], unsigned int spriteSize, const unsigned char* elongatedSprite);
     static std::string folderNameFromSheetName(const std::string &sheetPath, const SpriteSheetType &type);
 };
 
-/**
- * An interface that obscures the type of iterator (fs::directory_iterator or fs::recursive_directory_iterator).
- * The IO class does not care, it just wants the next path to evaluate.
- */
-class ignorant_directory_iterator {
-public:
-    virtual const fs::path& operator*() = 0;
-    virtual const fs::path* operator->() = 0;
-    virtual ignorant_directory_iterator& operator++() = 0;
-    virtual bool end() = 0;
-    // aliases for the operator overloads
-    [[maybe_unused]] virtual const fs::path& get() = 0;
-    [[maybe_unused]] virtual void next() = 0;
-    virtual ~ignorant_directory_iterator() = default;
-};
-
-class directory_iterator : public ignorant_directory_iterator {
-    fs::directory_iterator* iterator;
-public:
-    directory_iterator() = delete;
-    explicit directory_iterator(fs::directory_iterator* di) : iterator(di) {};
-    const fs::path& operator*() final { return (*iterator)->path(); }
-    const fs::path* operator->() final { return &((*iterator)->path()); }
-    directory_iterator& operator++() final { ++(*iterator); return *this; }
-    bool end() final { return *iterator == fs::end(*iterator); }
-    const fs::path& get() final { return (*iterator)->path(); }
-    void next() final { ++(*iterator); }
-    ~directory_iterator() override { delete iterator; }
-};
-
-class recursive_directory_iterator : public ignorant_directory_iterator {
-    fs::recursive_directory_iterator* iterator;
-public:
-    recursive_directory_iterator() = delete;
-    explicit recursive_directory_iterator(fs::recursive_directory_iterator* rdi) : iterator(rdi) {};
-    const fs::path& operator*() final { return (*iterator)->path(); }
-    const fs::path* operator->() final { return &((*iterator)->path()); }
-    recursive_directory_iterator& operator++() final { ++(*iterator); return *this; }
-    bool end() final { return *iterator == fs::end(*iterator); }
-    const fs::path& get() final { return (*iterator)->path(); }
-    void next() final { ++(*iterator); }
-    ~recursive_directory_iterator() override { delete iterator; }
-};
-
 #endif //SPRITESHEETSPLITTER_SPRITESHEETIO_H
@@ -0,0 +1,303 @@
+#include "ArchiveWriter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include "../codec/Checksum.hpp"
+
+namespace {
+
+constexpr size_t TAR_BLOCK = 512;
+constexpr size_t TAR_NAME_SIZE = 100;
+constexpr size_t TAR_PREFIX_SIZE = 155;
+
+constexpr uint32_t ZIP_LOCAL_HEADER = 0x04034b50;
+constexpr uint32_t ZIP_CENTRAL_HEADER = 0x02014b50;
+constexpr uint32_t ZIP_END = 0x06054b50;
+constexpr uint32_t ZIP64_END = 0x06064b50;
+constexpr uint32_t ZIP64_END_LOCATOR = 0x07064b50;
+constexpr uint16_t ZIP64_EXTRA = 0x0001;
+constexpr uint16_t ZIP_VERSION = 10; // 1.0: stored entries.
+constexpr uint16_t ZIP64_VERSION = 45;
+constexpr uint16_t ZIP_MADE_BY_UNIX = (3u << 8u) | ZIP64_VERSION;
+constexpr uint16_t ZIP_UTF8_NAMES = 1u << 11u;
+constexpr uint32_t ZIP_FILE_MODE = 0100644u << 16u; // regular file, rw-r--r--, in the high half of the external attributes.
+constexpr uint64_t ZIP_MAX_16 = 0xffff;
+constexpr uint64_t ZIP_MAX_32 = 0xffffffff;
+
+void put16(std::vector<unsigned char>& out, uint64_t v) {
+    out.push_back(v & 255u);
+    out.push_back((v >> 8u) & 255u);
+}
+
+void put32(std::vector<unsigned char>& out, uint64_t v) {
+    put16(out, v & 0xffffu);
+    put16(out, (v >> 16u) & 0xffffu);
+}
+
+void put64(std::vector<unsigned char>& out, uint64_t v) {
+    put32(out, v & 0xffffffffu);
+    put32(out, v >> 32u);
+}
+
+void putBytes(std::vector<unsigned char>& out, const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+// Zero bytes up to the next multiple of TAR_BLOCK.
+void padTarBlock(std::vector<unsigned char>& out) {
+    out.resize((out.size() + TAR_BLOCK - 1) / TAR_BLOCK * TAR_BLOCK, 0);
+}
+
+// An octal number field of a tar header: digits with leading zeroes, and a NUL.
+void tarOctal(unsigned char* field, size_t fieldSize, uint64_t value) {
+    for (size_t i = fieldSize - 1; i-- > 0;) {
+        field[i] = '0' + (value & 7u);
+        value >>= 3u;
+    }
+    field[fieldSize - 1] = '\0';
+}
+
+/**
+ * Split a path into the ustar name and prefix fields, at a '/'. Returns false if it does not fit them.
+ */
+bool splitTarPath(const std::string& path, std::string& prefix, std::string& name) {
+    if (path.size() <= TAR_NAME_SIZE) {
+        prefix.clear();
+        name = path;
+        return true;
+    }
+    for (size_t slash = path.find('/'); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        if (slash <= TAR_PREFIX_SIZE && path.size() - slash - 1 <= TAR_NAME_SIZE) {
+            prefix = path.substr(0, slash);
+            name = path.substr(slash + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void tarHeader(std::vector<unsigned char>& out, const std::string& prefix, const std::string& name, uint64_t size, std::time_t modified, char type) {
+    unsigned char header[TAR_BLOCK] = {};
+    std::memcpy(header, name.data(), std::min(name.size(), TAR_NAME_SIZE));
+    tarOctal(header + 100, 8, 0644); // mode
+    tarOctal(header + 108, 8, 0); // uid
+    tarOctal(header + 116, 8, 0); // gid
+    tarOctal(header + 124, 12, size);
+    tarOctal(header + 136, 12, static_cast<uint64_t>(modified));
+    header[156] = type;
+    std::memcpy(header + 257, "ustar", 6);
+    std::memcpy(header + 263, "00", 2);
+    std::memcpy(header + 345, prefix.data(), std::min(prefix.size(), TAR_PREFIX_SIZE));
+
+    // the checksum is the sum of the header bytes, with the checksum field itself counted as spaces.
+    std::memset(header + 148, ' ', 8);
+    unsigned int checksum = 0;
+    for (unsigned char c : header) checksum += c;
+    tarOctal(header + 148, 7, checksum);
+
+    putBytes(out, header, TAR_BLOCK);
+}
+
+// A pax extended header record: "<length> <key>=<value>\n", where the length counts its own digits too.
+std::string paxRecord(const std::string& key, const std::string& value) {
+    const size_t base = key.size() + value.size() + 3; // space, '=' and newline.
+    size_t length = base + std::to_string(base).size();
+    if (std::to_string(length).size() != std::to_string(base).size()) ++length;
+    return std::to_string(length) + ' ' + key + '=' + value + '\n';
+}
+
+void dosTime(std::time_t time, uint16_t& dosTime, uint16_t& dosDate) {
+    std::tm local {};
+    localtime_r(&time, &local);
+    if (local.tm_year < 80) { // DOS time starts in 1980.
+        dosTime = 0;
+        dosDate = (1u << 5u) | 1u;
+        return;
+    }
+    dosTime = (local.tm_hour << 11u) | (local.tm_min << 5u) | (local.tm_sec / 2);
+    dosDate = ((local.tm_year - 80) << 9u) | ((local.tm_mon + 1) << 5u) | local.tm_mday;
+}
+
+} // namespace
+
+// static
+std::unique_ptr<ArchiveWriter> ArchiveWriter::create(ArchiveFormat format) {
+    switch (format) {
+        case ArchiveFormat::TAR:
+            return std::make_unique<TarWriter>();
+        case ArchiveFormat::ZIP:
+            return std::make_unique<ZipWriter>();
+        case ArchiveFormat::NONE:
+        default:
+            return nullptr;
+    }
+}
+
+bool ArchiveWriter::open(const std::string& fileName) {
+    file_.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    modified_ = std::time(nullptr);
+    offset_ = 0;
+    failed_ = !file_.is_open();
+    return !failed_;
+}
+
+bool ArchiveWriter::append(const std::vector<Entry>& entries) {
+    std::vector<unsigned char> block;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (failed_) return false;
+
+    encodeEntries(entries, block);
+    if (!write(block)) {
+        dropEntries(entries.size());
+        return false;
+    }
+    entryCount_ += entries.size();
+    return true;
+}
+
+bool ArchiveWriter::finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!failed_) {
+        std::vector<unsigned char> block;
+        encodeEnd(block);
+        write(block);
+    }
+    file_.close();
+    return !failed_ && !file_.fail();
+}
+
+bool ArchiveWriter::write(const std::vector<unsigned char>& block) {
+    file_.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(block.size()));
+    failed_ = file_.fail();
+    if (!failed_) offset_ += block.size();
+    return !failed_;
+}
+
+/**
+ * Paths that do not fit the ustar name and prefix fields get a pax extended header with the full path first.
+ */
+void TarWriter::encodeEntries(const std::vector<Entry>& entries, std::vector<unsigned char>& block) {
+    size_t total = 0;
+    for (const Entry& entry : entries) total += 2 * TAR_BLOCK + entry.data.size();
+    block.reserve(total);
+
+    std::string prefix;
+    std::string name;
+    for (const Entry& entry : entries) {
+        if (!splitTarPath(entry.path, prefix, name)) {
+            const std::string record = paxRecord("path", entry.path);
+            tarHeader(block, "", "PaxHeader", record.size(), modified_, 'x');
+            putBytes(block, record.data(), record.size());
+            padTarBlock(block);
+            prefix.clear();
+            name = entry.path.substr(entry.path.size() - TAR_NAME_SIZE); // a fallback for readers without pax support.
+        }
+        tarHeader(block, prefix, name, entry.data.size(), modified_, '0');
+        putBytes(block, entry.data.data(), entry.data.size());
+        padTarBlock(block);
+    }
+}
+
+void TarWriter::encodeEnd(std::vector<unsigned char>& block) {
+    block.assign(2 * TAR_BLOCK, 0);
+}
+
+void ZipWriter::encodeEntries(const std::vector<Entry>& entries, std::vector<unsigned char>& block) {
+    uint16_t time;
+    uint16_t date;
+    dosTime(modified_, time, date);
+
+    for (const Entry& entry : entries) {
+        const uint32_t crc = Checksum::crc32(0, entry.data.data(), entry.data.size());
+        const auto size = static_cast<uint32_t>(entry.data.size());
+        central_.push_back({entry.path, crc, size, offset_ + block.size()});
+
+        put32(block, ZIP_LOCAL_HEADER);
+        put16(block, ZIP_VERSION);
+        put16(block, ZIP_UTF8_NAMES);
+        put16(block, 0); // stored
+        put16(block, time);
+        put16(block, date);
+        put32(block, crc);
+        put32(block, size); // compressed
+        put32(block, size);
+        put16(block, entry.path.size());
+        put16(block, 0); // extra field
+        putBytes(block, entry.path.data(), entry.path.size());
+        putBytes(block, entry.data.data(), entry.data.size());
+    }
+}
+
+void ZipWriter::dropEntries(size_t count) {
+    central_.resize(central_.size() - count);
+}
+
+/**
+ * The central directory, and its end record. ZIP64 is used for what does not fit the 16 and 32 bit fields:
+ * more than 65535 files, or files and directory starting beyond 4 GiB.
+ */
+void ZipWriter::encodeEnd(std::vector<unsigned char>& block) {
+    uint16_t time;
+    uint16_t date;
+    dosTime(modified_, time, date);
+
+    const uint64_t directoryOffset = offset_;
+    for (const CentralEntry& entry : central_) {
+        const bool farOffset = entry.localHeaderOffset >= ZIP_MAX_32;
+        put32(block, ZIP_CENTRAL_HEADER);
+        put16(block, ZIP_MADE_BY_UNIX);
+        put16(block, farOffset ? ZIP64_VERSION : ZIP_VERSION);
+        put16(block, ZIP_UTF8_NAMES);
+        put16(block, 0); // stored
+        put16(block, time);
+        put16(block, date);
+        put32(block, entry.crc);
+        put32(block, entry.size);
+        put32(block, entry.size);
+        put16(block, entry.path.size());
+        put16(block, farOffset ? 12 : 0); // extra field
+        put16(block, 0); // comment
+        put16(block, 0); // disk
+        put16(block, 0); // internal attributes
+        put32(block, ZIP_FILE_MODE);
+        put32(block, farOffset ? ZIP_MAX_32 : entry.localHeaderOffset);
+        putBytes(block, entry.path.data(), entry.path.size());
+        if (farOffset) {
+            put16(block, ZIP64_EXTRA);
+            put16(block, 8);
+            put64(block, entry.localHeaderOffset);
+        }
+    }
+    const uint64_t directorySize = block.size();
+    const uint64_t count = central_.size();
+
+    const bool zip64 = count >= ZIP_MAX_16 || directorySize >= ZIP_MAX_32 || directoryOffset >= ZIP_MAX_32;
+    if (zip64) {
+        const uint64_t zip64EndOffset = directoryOffset + block.size();
+        put32(block, ZIP64_END);
+        put64(block, 44); // size of the rest of this record
+        put16(block, ZIP_MADE_BY_UNIX);
+        put16(block, ZIP64_VERSION);
+        put32(block, 0); // disk
+        put32(block, 0); // disk of the directory
+        put64(block, count);
+        put64(block, count);
+        put64(block, directorySize);
+        put64(block, directoryOffset);
+
+        put32(block, ZIP64_END_LOCATOR);
+        put32(block, 0); // disk of the zip64 end record
+        put64(block, zip64EndOffset);
+        put32(block, 1); // total disks
+    }
+
+    put32(block, ZIP_END);
+    put16(block, 0); // disk
+    put16(block, 0); // disk of the directory
+    put16(block, std::min(count, ZIP_MAX_16));
+    put16(block, std::min(count, ZIP_MAX_16));
+    put32(block, std::min(directorySize, ZIP_MAX_32));
+    put32(block, std::min(directoryOffset, ZIP_MAX_32));
+    put16(block, 0); // comment
+}
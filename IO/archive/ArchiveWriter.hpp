@@ -0,0 +1,84 @@
+#ifndef SPRITESHEETSPLITTER_ARCHIVEWRITER_HPP
+#define SPRITESHEETSPLITTER_ARCHIVEWRITER_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../../util/ArchiveFormat.h"
+
+/**
+ * Streams the saved sprites of a job into one archive file, sequentially.
+ *
+ * Sheets are saved in parallel. Each one hands over all its files at once: they are serialized into one block
+ * (headers and data), and appended with a single write under a lock. The files of a sheet stay together in the archive.
+ * finish writes what comes after the last file (the tar end blocks, or the ZIP central directory).
+ */
+class ArchiveWriter {
+public:
+    struct Entry {
+        std::string path; // relative path inside the archive, with '/' separators.
+        std::vector<unsigned char> data;
+    };
+
+    // A writer for format, or nullptr for ArchiveFormat::NONE.
+    static std::unique_ptr<ArchiveWriter> create(ArchiveFormat format);
+    virtual ~ArchiveWriter() = default;
+
+    // Create (or truncate) the archive file. Returns false if that fails.
+    bool open(const std::string& fileName);
+    // Append the files of one sheet. Thread safe. Returns false if writing failed: the files are not in the archive.
+    bool append(const std::vector<Entry>& entries);
+    // Write the end of the archive and close it. Returns false if that, or any append before, failed.
+    bool finish();
+    // Files appended so far.
+    [[nodiscard]] size_t entryCount() const { return entryCount_; }
+
+protected:
+    uint64_t offset_ = 0; // bytes written so far.
+    std::time_t modified_ = 0; // the time of open, used as modification time of every file.
+
+    // Serialize entries into block, as they go at offset_.
+    virtual void encodeEntries(const std::vector<Entry>& entries, std::vector<unsigned char>& block) = 0;
+    // Serialize the end of the archive into block.
+    virtual void encodeEnd(std::vector<unsigned char>& block) = 0;
+    // Undo what encodeEntries recorded for the last entries, because they could not be written.
+    virtual void dropEntries(size_t /*count*/) {}
+
+private:
+    std::ofstream file_;
+    std::mutex mutex_;
+    size_t entryCount_ = 0;
+    bool failed_ = false;
+
+    bool write(const std::vector<unsigned char>& block);
+};
+
+// POSIX ustar: a 512 byte header per file, data padded to 512 bytes, and two zero blocks at the end.
+class TarWriter : public ArchiveWriter {
+protected:
+    void encodeEntries(const std::vector<Entry>& entries, std::vector<unsigned char>& block) final;
+    void encodeEnd(std::vector<unsigned char>& block) final;
+};
+
+// ZIP with 'stored' entries: local headers and data, then the central directory. ZIP64 records are added when needed.
+class ZipWriter : public ArchiveWriter {
+protected:
+    void encodeEntries(const std::vector<Entry>& entries, std::vector<unsigned char>& block) final;
+    void encodeEnd(std::vector<unsigned char>& block) final;
+    void dropEntries(size_t count) final;
+
+private:
+    struct CentralEntry {
+        std::string path;
+        uint32_t crc;
+        uint32_t size;
+        uint64_t localHeaderOffset;
+    };
+    std::vector<CentralEntry> central_;
+};
+
+#endif //SPRITESHEETSPLITTER_ARCHIVEWRITER_HPP
@@ -0,0 +1,165 @@
+#include "AtlasWriter.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include "lodepng.h"
+
+namespace {
+
+// Escape a string for a JSON string literal. Sheet names are file names: quotes, backslashes and control characters are possible.
+std::string jsonString(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+} // namespace
+
+void AtlasWriter::append(std::vector<Sprite>&& sprites) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sprites_.insert(sprites_.end(), std::make_move_iterator(sprites.begin()), std::make_move_iterator(sprites.end()));
+}
+
+bool AtlasWriter::uniqueNames(std::string& duplicate) const {
+    std::vector<const std::string*> names;
+    names.reserve(sprites_.size());
+    for (const Sprite& sprite : sprites_) names.push_back(&sprite.name);
+    std::sort(names.begin(), names.end(), [](const std::string* a, const std::string* b) { return *a < *b; });
+    const auto same = std::adjacent_find(names.begin(), names.end(), [](const std::string* a, const std::string* b) { return *a == *b; });
+    if (same == names.end()) return true;
+    duplicate = **same;
+    return false;
+}
+
+/**
+ * Shelf packing. Sprites go left to right on a shelf as high as the first (highest) sprite on it,
+ * a new shelf starts below when the next sprite does not fit the width, and a new atlas when it does not fit the height.
+ * Atlases are cropped to what is used. A sprite larger than ATLAS_SIZE gets an atlas of its own size.
+ */
+// static
+void AtlasWriter::pack(const std::vector<Sprite>& sprites, std::vector<Placement>& placements, std::vector<Atlas>& atlases) {
+    std::vector<size_t> order(sprites.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&sprites](size_t a, size_t b) {
+        const Sprite& l = sprites[a];
+        const Sprite& r = sprites[b];
+        if (l.height != r.height) return l.height > r.height;
+        if (l.width != r.width) return l.width > r.width;
+        return l.name < r.name;
+    });
+
+    placements.clear();
+    atlases.clear();
+    unsigned int x = 0;
+    unsigned int y = 0;
+    unsigned int shelfHeight = 0;
+    for (size_t index : order) {
+        const Sprite& sprite = sprites[index];
+        if (!atlases.empty() && x + sprite.width > ATLAS_SIZE) { // next shelf
+            y += shelfHeight;
+            x = 0;
+            shelfHeight = 0;
+        }
+        if (atlases.empty() || (x == 0 && y > 0 && y + sprite.height > ATLAS_SIZE)) { // next atlas
+            atlases.push_back({0, 0});
+            x = 0;
+            y = 0;
+            shelfHeight = 0;
+        }
+
+        Atlas& atlas = atlases.back();
+        placements.push_back({index, static_cast<unsigned int>(atlases.size() - 1), x, y});
+        x += sprite.width;
+        shelfHeight = std::max(shelfHeight, sprite.height);
+        atlas.width = std::max(atlas.width, x);
+        atlas.height = std::max(atlas.height, y + sprite.height);
+    }
+}
+
+unsigned int AtlasWriter::finish(const std::filesystem::path& folder, const std::string& baseName, const std::string& extension, const Encoder& encode) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pack(sprites_, placements_, atlases_);
+
+    // one atlas at a time: a full 2048x2048 atlas is 16 MiB of pixels.
+    std::vector<std::string> atlasFiles;
+    size_t next = 0; // placements are in atlas order.
+    for (unsigned int a = 0; a < atlases_.size(); ++a) {
+        const Atlas& atlas = atlases_[a];
+        std::vector<unsigned char> pixels(static_cast<size_t>(atlas.width) * atlas.height * 4, 0);
+        for (; next < placements_.size() && placements_[next].atlas == a; ++next) {
+            const Placement& placement = placements_[next];
+            const Sprite& sprite = sprites_[placement.sprite];
+            for (unsigned int row = 0; row < sprite.height; ++row) {
+                std::memcpy(pixels.data() + ((static_cast<size_t>(placement.y) + row) * atlas.width + placement.x) * 4,
+                            sprite.rgba.data() + static_cast<size_t>(row) * sprite.width * 4, static_cast<size_t>(sprite.width) * 4);
+            }
+        }
+
+        std::vector<unsigned char> encoded;
+        atlasFiles.push_back(baseName + '_' + std::to_string(a) + extension);
+        unsigned int error = encode(encoded, pixels.data(), atlas.width, atlas.height);
+        if (!error) error = lodepng::save_file(encoded, (folder / atlasFiles.back()).string());
+        if (error) return error;
+    }
+
+    // 79: lodepng's "failed to open file for writing".
+    return writeIndex(folder / (baseName + ".json"), atlasFiles) ? 0 : 79;
+}
+
+double AtlasWriter::fill() const {
+    double spritePixels = 0;
+    double atlasPixels = 0;
+    for (const Sprite& sprite : sprites_) spritePixels += static_cast<double>(sprite.width) * sprite.height;
+    for (const Atlas& atlas : atlases_) atlasPixels += static_cast<double>(atlas.width) * atlas.height;
+    return atlasPixels > 0 ? spritePixels / atlasPixels : 0;
+}
+
+/**
+ * {
+ *   "atlases": [ {"file": "sheets_0.png", "width": 2048, "height": 1024}, ... ],
+ *   "sprites": { "AbyssObjects16/0.png": {"atlas": 0, "x": 0, "y": 0, "width": 16, "height": 16}, ... }
+ * }
+ * Sprites are listed in name order.
+ */
+bool AtlasWriter::writeIndex(const std::filesystem::path& file, const std::vector<std::string>& atlasFiles) const {
+    std::vector<const Placement*> byName;
+    byName.reserve(placements_.size());
+    for (const Placement& placement : placements_) byName.push_back(&placement);
+    std::sort(byName.begin(), byName.end(), [this](const Placement* a, const Placement* b) { return sprites_[a->sprite].name < sprites_[b->sprite].name; });
+
+    std::ofstream json(file, std::ios::out | std::ios::trunc);
+    json << "{\n  \"atlases\": [";
+    for (size_t a = 0; a < atlases_.size(); ++a) {
+        json << (a ? "," : "") << "\n    {\"file\": " << jsonString(atlasFiles[a]) << ", \"width\": " << atlases_[a].width << ", \"height\": " << atlases_[a].height << "}";
+    }
+    json << "\n  ],\n  \"sprites\": {";
+    for (size_t i = 0; i < byName.size(); ++i) {
+        const Placement& placement = *byName[i];
+        const Sprite& sprite = sprites_[placement.sprite];
+        json << (i ? "," : "") << "\n    " << jsonString(sprite.name) << ": {\"atlas\": " << placement.atlas << ", \"x\": " << placement.x << ", \"y\": " << placement.y
+             << ", \"width\": " << sprite.width << ", \"height\": " << sprite.height << "}";
+    }
+    json << "\n  }\n}\n";
+    json.close();
+    return !json.fail();
+}
@@ -0,0 +1,72 @@
+#ifndef SPRITESHEETSPLITTER_ATLASWRITER_HPP
+#define SPRITESHEETSPLITTER_ATLASWRITER_HPP
+
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Repacks the sprites of a job into as few atlases as fit them, without the empty tiles of the source sheets,
+ * and writes the atlases with a JSON index: sprite name -> atlas and rectangle.
+ *
+ * Sheets are saved in parallel, and hand their sprites over with append. Packing waits for finish,
+ * so that the layout only depends on the set of sprites, not on the order threads finished in:
+ * the sprites are sorted by height (then width and name), and placed on shelves, left to right and top to bottom.
+ * Split sprites come in a few sizes, which makes shelves about as tight as any packer gets.
+ */
+class AtlasWriter {
+public:
+    struct Sprite {
+        std::string name; // the path the sprite would have as loose file, relative to the output directory.
+        unsigned int width;
+        unsigned int height;
+        std::vector<unsigned char> rgba;
+    };
+
+    struct Placement {
+        size_t sprite; // index into the sprites
+        unsigned int atlas;
+        unsigned int x;
+        unsigned int y;
+    };
+
+    struct Atlas {
+        unsigned int width;
+        unsigned int height;
+    };
+
+    // Encodes an atlas to file contents. Returns a lodePNG error code (0 = OK).
+    using Encoder = std::function<unsigned int(std::vector<unsigned char>& out, const unsigned char* rgba, unsigned int width, unsigned int height)>;
+
+    static constexpr unsigned int ATLAS_SIZE = 2048; // the largest width and height of an atlas. Any GPU handles this.
+
+    // Add the sprites of one sheet. Thread safe.
+    void append(std::vector<Sprite>&& sprites);
+    // Whether no two sprites have the same name, as the index needs. If two have, duplicate receives their name.
+    [[nodiscard]] bool uniqueNames(std::string& duplicate) const;
+    /**
+     * Pack and write '<baseName>_<n><extension>' for every atlas, and '<baseName>.json', into folder.
+     * @return a lodePNG error code (0 = OK) of the first atlas that failed to encode or save.
+     */
+    unsigned int finish(const std::filesystem::path& folder, const std::string& baseName, const std::string& extension, const Encoder& encode);
+
+    [[nodiscard]] size_t spriteCount() const { return sprites_.size(); }
+    [[nodiscard]] size_t atlasCount() const { return atlases_.size(); }
+    // Sprite pixels over atlas pixels, after finish.
+    [[nodiscard]] double fill() const;
+
+    // Place sprites on shelves. Fills placements (in packing order) and atlases.
+    static void pack(const std::vector<Sprite>& sprites, std::vector<Placement>& placements, std::vector<Atlas>& atlases);
+
+private:
+    std::mutex mutex_;
+    std::vector<Sprite> sprites_;
+    std::vector<Placement> placements_;
+    std::vector<Atlas> atlases_;
+
+    bool writeIndex(const std::filesystem::path& file, const std::vector<std::string>& atlasFiles) const;
+};
+
+#endif //SPRITESHEETSPLITTER_ATLASWRITER_HPP
@@ -0,0 +1,125 @@
+#include "SpriteBundle.hpp"
+
+#include <cstring>
+#include "../codec/Checksum.hpp"
+
+SpriteBundle::~SpriteBundle() {
+    close();
+}
+
+/**
+ * Map a bundle read-only. If mmap is not possible (e.g. on some network filesystems, or off Linux), the file is read into memory instead,
+ * which costs a copy but behaves the same. See MappedFile.
+ */
+bool SpriteBundle::open(const std::string& path, std::string& error) {
+    close();
+
+    if (!file_.open(path, MappedFile::Access::NORMAL)) {
+        error = "cannot read " + path;
+        return false;
+    }
+    data_ = file_.data();
+    size_ = file_.size();
+    if (size_ < HEADER_SIZE) {
+        close();
+        error = "not a sprite bundle, too small: " + path;
+        return false;
+    }
+
+    if (!parse(error)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SpriteBundle::close() {
+    file_.close();
+    data_ = nullptr;
+    size_ = 0;
+    sprites_.clear();
+}
+
+/**
+ * Check the header, and that every index entry lies within the file. Builds sprites_.
+ */
+bool SpriteBundle::parse(std::string& error) {
+    const unsigned char* h = data_;
+    if (std::memcmp(h, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "not a sprite bundle: wrong magic";
+        return false;
+    }
+    if (load32(h + 8) != VERSION) {
+        error = "unsupported bundle version " + std::to_string(load32(h + 8));
+        return false;
+    }
+    const uint32_t payload = load32(h + 12);
+    const uint64_t count = load32(h + 16);
+    const uint32_t alignment = load32(h + 20);
+    const uint64_t indexOffset = load64(h + 24);
+    const uint64_t fileSize = load64(h + 40);
+    if (payload > static_cast<uint32_t>(Payload::QOI)) {
+        error = "unknown payload format " + std::to_string(payload);
+        return false;
+    }
+    if (fileSize != size_) {
+        error = "truncated: the header says " + std::to_string(fileSize) + " bytes, the file has " + std::to_string(size_);
+        return false;
+    }
+    if (alignment == 0 || indexOffset < HEADER_SIZE || indexOffset > size_ || count > (size_ - indexOffset) / ENTRY_SIZE) {
+        error = "index out of bounds";
+        return false;
+    }
+    const unsigned char* index = data_ + indexOffset;
+    if (Checksum::crc32(0, index, count * ENTRY_SIZE) != load32(h + 48)) {
+        error = "index checksum mismatch";
+        return false;
+    }
+    payload_ = static_cast<Payload>(payload);
+
+    sprites_.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        const unsigned char* entry = index + i * ENTRY_SIZE;
+        const auto* name = reinterpret_cast<const char*>(entry);
+        const size_t nameLength = strnlen(name, NAME_SIZE);
+        const uint64_t offset = load64(entry + 48);
+        const uint64_t size = load32(entry + 56);
+        if (nameLength == NAME_SIZE || nameLength == 0) {
+            error = "sprite " + std::to_string(i) + " has no valid name";
+            return false;
+        }
+        if (offset % alignment != 0 || offset < indexOffset + count * ENTRY_SIZE || offset > size_ || size > size_ - offset) {
+            error = "payload of sprite '" + std::string(name, nameLength) + "' out of bounds";
+            return false;
+        }
+        Sprite sprite {std::string_view(name, nameLength), load32(entry + 40), load32(entry + 44), data_ + offset, size, load32(entry + 60)};
+        if (payload_ == Payload::RGBA && static_cast<uint64_t>(sprite.width) * sprite.height * 4 != size) {
+            error = "size of sprite '" + std::string(sprite.name) + "' does not match its dimensions";
+            return false;
+        }
+        sprites_.push_back(sprite);
+    }
+    return true;
+}
+
+const SpriteBundle::Sprite* SpriteBundle::find(std::string_view name) const {
+    for (const Sprite& sprite : sprites_) {
+        if (sprite.name == name) return &sprite;
+    }
+    return nullptr;
+}
+
+// static
+bool SpriteBundle::verify(const Sprite& sprite) {
+    return Checksum::crc32(0, sprite.data, sprite.size) == sprite.checksum;
+}
+
+// static
+uint32_t SpriteBundle::load32(const unsigned char* p) {
+    return p[0] | (p[1] << 8u) | (p[2] << 16u) | (static_cast<uint32_t>(p[3]) << 24u);
+}
+
+// static
+uint64_t SpriteBundle::load64(const unsigned char* p) {
+    return load32(p) | (static_cast<uint64_t>(load32(p + 4)) << 32u);
+}
@@ -0,0 +1,95 @@
+#ifndef SPRITESHEETSPLITTER_SPRITEBUNDLE_HPP
+#define SPRITESHEETSPLITTER_SPRITEBUNDLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../file/MappedFile.hpp"
+
+/**
+ * Reader for sprite bundles: all sprites of one sheet in a single file, written by SpriteBundleWriter (see --bundle).
+ *
+ * The file is mapped into memory, and sprite payloads are handed out as pointers into the mapping: nothing is copied.
+ * Only the index is parsed when opening, and checked to lie within the file. Payload checksums are checked on request.
+ *
+ * Layout. All integers are little-endian.
+ *
+ * Header, HEADER_SIZE (64) bytes:
+ *   0  char[8]  MAGIC "SPRBNDL\0"
+ *   8  u32      VERSION
+ *   12 u32      payload format, see Payload
+ *   16 u32      sprite count
+ *   20 u32      payload alignment: every payload offset is a multiple of it
+ *   24 u64      index offset (HEADER_SIZE)
+ *   32 u64      offset of the first payload
+ *   40 u64      file size
+ *   48 u32      CRC32 of the index
+ *   52          reserved, zero
+ *
+ * Index, ENTRY_SIZE (64) bytes per sprite, in the order the sprites were written:
+ *   0  char[40] name: the file name the sprite has as loose file, without extension. NUL padded, at least one NUL.
+ *   40 u32      width
+ *   44 u32      height
+ *   48 u64      payload offset, from the start of the file
+ *   56 u32      payload size
+ *   60 u32      CRC32 of the payload
+ *
+ * Payloads follow, each padded with zeroes up to the alignment.
+ */
+class SpriteBundle {
+public:
+    enum class Payload : uint32_t {
+        RGBA = 0, // width * height * 4 bytes, rows top to bottom. Can be handed to e.g. a texture upload as is.
+        PNG = 1,
+        QOI = 2,
+    };
+
+    struct Sprite {
+        std::string_view name; // points into the mapping.
+        uint32_t width;
+        uint32_t height;
+        const unsigned char* data; // points into the mapping.
+        size_t size;
+        uint32_t checksum;
+    };
+
+    static constexpr char MAGIC[8] = {'S', 'P', 'R', 'B', 'N', 'D', 'L', '\0'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr size_t ENTRY_SIZE = 64;
+    static constexpr size_t NAME_SIZE = 40;
+    static constexpr uint32_t ALIGNMENT = 64; // a cache line, and more than any SIMD load or texture upload needs.
+    static constexpr const char* EXTENSION = ".sprites";
+
+    SpriteBundle() = default;
+    ~SpriteBundle();
+    SpriteBundle(const SpriteBundle&) = delete;
+    SpriteBundle& operator=(const SpriteBundle&) = delete;
+
+    // Map the bundle at path. Returns false, with the reason in error, if it cannot be read or its header or index is invalid.
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    [[nodiscard]] Payload payload() const { return payload_; }
+    [[nodiscard]] const std::vector<Sprite>& sprites() const { return sprites_; }
+    // The sprite with this name, or nullptr. Linear: bundles hold one sheet, a few hundred sprites at most.
+    [[nodiscard]] const Sprite* find(std::string_view name) const;
+    // Whether the payload of a sprite still matches its checksum.
+    [[nodiscard]] static bool verify(const Sprite& sprite);
+
+    static uint32_t load32(const unsigned char* p);
+    static uint64_t load64(const unsigned char* p);
+
+private:
+    MappedFile file_;
+    const unsigned char* data_ = nullptr; // the contents of file_.
+    size_t size_ = 0;
+    Payload payload_ = Payload::RGBA;
+    std::vector<Sprite> sprites_;
+
+    bool parse(std::string& error);
+};
+
+#endif //SPRITESHEETSPLITTER_SPRITEBUNDLE_HPP
@@ -0,0 +1,75 @@
+#include "SpriteBundleWriter.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "../codec/Checksum.hpp"
+
+void SpriteBundleWriter::add(std::string_view name, unsigned int width, unsigned int height, const unsigned char* data, size_t size) {
+    if (name.empty() || name.size() >= SpriteBundle::NAME_SIZE || size > UINT32_MAX) {
+        throw std::logic_error("Sprite '" + std::string(name) + "' does not fit a bundle index entry.");
+    }
+
+    const size_t entryOffset = index_.size();
+    index_.resize(entryOffset + SpriteBundle::ENTRY_SIZE, 0);
+    unsigned char* entry = index_.data() + entryOffset;
+    std::memcpy(entry, name.data(), name.size());
+    store32(entry + 40, width);
+    store32(entry + 44, height);
+    store64(entry + 48, payloads_.size());
+    store32(entry + 56, static_cast<uint32_t>(size));
+    store32(entry + 60, Checksum::crc32(0, data, size));
+
+    const size_t padded = (size + SpriteBundle::ALIGNMENT - 1) / SpriteBundle::ALIGNMENT * SpriteBundle::ALIGNMENT;
+    const size_t payloadOffset = payloads_.size();
+    payloads_.resize(payloadOffset + padded, 0);
+    if (size > 0) std::memcpy(payloads_.data() + payloadOffset, data, size);
+}
+
+/**
+ * The index is written right after the header, and the payloads after the index, from the next aligned offset.
+ */
+bool SpriteBundleWriter::save(const std::string& path) const {
+    const size_t indexEnd = SpriteBundle::HEADER_SIZE + index_.size();
+    const size_t dataOffset = (indexEnd + SpriteBundle::ALIGNMENT - 1) / SpriteBundle::ALIGNMENT * SpriteBundle::ALIGNMENT;
+
+    // the index, with payload offsets from the start of the file.
+    std::vector<unsigned char> index(index_);
+    for (size_t entry = 0; entry < index.size(); entry += SpriteBundle::ENTRY_SIZE) {
+        store64(index.data() + entry + 48, SpriteBundle::load64(index.data() + entry + 48) + dataOffset);
+    }
+
+    unsigned char header[SpriteBundle::HEADER_SIZE] = {};
+    std::memcpy(header, SpriteBundle::MAGIC, sizeof(SpriteBundle::MAGIC));
+    store32(header + 8, SpriteBundle::VERSION);
+    store32(header + 12, static_cast<uint32_t>(payload_));
+    store32(header + 16, static_cast<uint32_t>(spriteCount()));
+    store32(header + 20, SpriteBundle::ALIGNMENT);
+    store64(header + 24, SpriteBundle::HEADER_SIZE);
+    store64(header + 32, dataOffset);
+    store64(header + 40, dataOffset + payloads_.size());
+    store32(header + 48, Checksum::crc32(0, index.data(), index.size()));
+
+    const std::vector<char> padding(dataOffset - indexEnd, 0);
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size()));
+    file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    file.write(reinterpret_cast<const char*>(payloads_.data()), static_cast<std::streamsize>(payloads_.size()));
+    file.close();
+    return !file.fail();
+}
+
+// static
+void SpriteBundleWriter::store32(unsigned char* p, uint32_t v) {
+    p[0] = v & 255u;
+    p[1] = (v >> 8u) & 255u;
+    p[2] = (v >> 16u) & 255u;
+    p[3] = v >> 24u;
+}
+
+// static
+void SpriteBundleWriter::store64(unsigned char* p, uint64_t v) {
+    store32(p, static_cast<uint32_t>(v));
+    store32(p + 4, static_cast<uint32_t>(v >> 32u));
+}
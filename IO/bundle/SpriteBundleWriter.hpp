@@ -0,0 +1,31 @@
+#ifndef SPRITESHEETSPLITTER_SPRITEBUNDLEWRITER_HPP
+#define SPRITESHEETSPLITTER_SPRITEBUNDLEWRITER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "SpriteBundle.hpp"
+
+/**
+ * Collects sprites in memory, and writes them as one sprite bundle (see SpriteBundle for the layout) with a single write.
+ */
+class SpriteBundleWriter {
+public:
+    explicit SpriteBundleWriter(SpriteBundle::Payload payload) : payload_(payload) {}
+
+    // Append a sprite. The payload is copied. Throws std::logic_error for a name that does not fit the index.
+    void add(std::string_view name, unsigned int width, unsigned int height, const unsigned char* data, size_t size);
+    // Write the bundle to path. Returns false if the file could not be written.
+    [[nodiscard]] bool save(const std::string& path) const;
+    [[nodiscard]] size_t spriteCount() const { return index_.size() / SpriteBundle::ENTRY_SIZE; }
+
+private:
+    SpriteBundle::Payload payload_;
+    std::vector<unsigned char> index_;
+    std::vector<unsigned char> payloads_; // offsets in index_ are relative to the start of this, until save adds the data offset.
+
+    static void store32(unsigned char* p, uint32_t v);
+    static void store64(unsigned char* p, uint64_t v);
+};
+
+#endif //SPRITESHEETSPLITTER_SPRITEBUNDLEWRITER_HPP
@@ -0,0 +1,116 @@
+#include "ApngEncoder.hpp"
+
+#include <cstring>
+#include "Checksum.hpp"
+
+namespace {
+
+constexpr size_t SIGNATURE_SIZE = 8;
+constexpr size_t FRAME_CONTROL_SIZE = 26;
+constexpr unsigned char DISPOSE_OP_NONE = 0;
+constexpr unsigned char BLEND_OP_SOURCE = 0;
+
+void put32(unsigned char* p, uint32_t v) {
+    p[0] = v >> 24u;
+    p[1] = (v >> 16u) & 255u;
+    p[2] = (v >> 8u) & 255u;
+    p[3] = v & 255u;
+}
+
+void put16(unsigned char* p, unsigned v) {
+    p[0] = (v >> 8u) & 255u;
+    p[1] = v & 255u;
+}
+
+} // namespace
+
+/**
+ * The chunks of the first frame are copied up to its last IDAT, with acTL and the frame control of the first frame before its
+ * first IDAT. The image data of every other frame follows as fdAT chunks, each frame behind its own fcTL.
+ * Then the rest of the first frame: chunks written after the image data, and IEND.
+ */
+// static
+unsigned ApngEncoder::encode(std::vector<unsigned char>& out, const std::vector<Frame>& frames, unsigned delayMs,
+                             lodepng::State& state, CompressionProfile profile, bool reduceColors) {
+    if (frames.empty() || frames[0].x != 0 || frames[0].y != 0) return 1;
+    const unsigned canvasWidth = frames[0].image.w;
+    const unsigned canvasHeight = frames[0].image.h;
+    std::vector<SpriteEncoder::Frame> images;
+    for (const Frame& frame : frames) {
+        if (frame.x + frame.image.w > canvasWidth || frame.y + frame.image.h > canvasHeight) return 1;
+        images.push_back(frame.image);
+    }
+
+    std::vector<std::vector<unsigned char>> pngs;
+    unsigned error = SpriteEncoder::encodeFrames(pngs, images, state, profile, reduceColors);
+    if (error) return error;
+
+    const std::vector<unsigned char>& first = pngs[0];
+    const unsigned char* end = first.data() + first.size();
+    const unsigned char* afterImageData = nullptr; // the chunk after the last IDAT of the first frame.
+    for (const unsigned char* chunk = first.data() + SIGNATURE_SIZE; chunk + 12 <= end; chunk = lodepng_chunk_next_const(chunk, end)) {
+        if (lodepng_chunk_type_equals(chunk, "IDAT")) afterImageData = lodepng_chunk_next_const(chunk, end);
+    }
+    if (!afterImageData) return 1;
+
+    out.clear();
+    out.reserve(first.size() + FRAME_CONTROL_SIZE * frames.size() * 2);
+    unsigned sequence = 0;
+    bool controlWritten = false;
+    out.insert(out.end(), first.data(), first.data() + SIGNATURE_SIZE);
+    for (const unsigned char* chunk = first.data() + SIGNATURE_SIZE; chunk < afterImageData; chunk = lodepng_chunk_next_const(chunk, end)) {
+        if (!controlWritten && lodepng_chunk_type_equals(chunk, "IDAT")) {
+            unsigned char animationControl[8];
+            put32(animationControl, frames.size());
+            put32(animationControl + 4, 0); // plays: forever.
+            putChunk(out, "acTL", animationControl, sizeof(animationControl));
+            putFrameControl(out, sequence++, frames[0], delayMs);
+            controlWritten = true;
+        }
+        out.insert(out.end(), chunk, lodepng_chunk_next_const(chunk, end));
+    }
+
+    std::vector<unsigned char> frameData;
+    for (size_t i = 1; i < frames.size(); ++i) {
+        putFrameControl(out, sequence++, frames[i], delayMs);
+        const unsigned char* frameEnd = pngs[i].data() + pngs[i].size();
+        for (const unsigned char* chunk = pngs[i].data() + SIGNATURE_SIZE; chunk + 12 <= frameEnd; chunk = lodepng_chunk_next_const(chunk, frameEnd)) {
+            if (!lodepng_chunk_type_equals(chunk, "IDAT")) continue;
+            // fdAT: the sequence number, then what would have been the IDAT data.
+            const unsigned length = lodepng_chunk_length(chunk);
+            frameData.resize(4 + length);
+            put32(frameData.data(), sequence++);
+            std::memcpy(frameData.data() + 4, lodepng_chunk_data_const(chunk), length);
+            putChunk(out, "fdAT", frameData.data(), frameData.size());
+        }
+    }
+
+    out.insert(out.end(), afterImageData, end);
+    return 0;
+}
+
+// static
+void ApngEncoder::putChunk(std::vector<unsigned char>& out, const char* type, const unsigned char* data, size_t length) {
+    const size_t start = out.size();
+    out.resize(start + 12 + length);
+    unsigned char* chunk = out.data() + start;
+    put32(chunk, length);
+    std::memcpy(chunk + 4, type, 4);
+    if (length) std::memcpy(chunk + 8, data, length);
+    put32(chunk + 8 + length, Checksum::crc32(0, chunk + 4, length + 4));
+}
+
+// static
+void ApngEncoder::putFrameControl(std::vector<unsigned char>& out, unsigned sequence, const Frame& frame, unsigned delayMs) {
+    unsigned char control[FRAME_CONTROL_SIZE];
+    put32(control, sequence);
+    put32(control + 4, frame.image.w);
+    put32(control + 8, frame.image.h);
+    put32(control + 12, frame.x);
+    put32(control + 16, frame.y);
+    put16(control + 20, delayMs);
+    put16(control + 22, 1000); // the delay is numerator / denominator seconds.
+    control[24] = DISPOSE_OP_NONE;
+    control[25] = BLEND_OP_SOURCE;
+    putChunk(out, "fcTL", control, sizeof(control));
+}
@@ -0,0 +1,41 @@
+#ifndef SPRITESHEETSPLITTER_APNGENCODER_HPP
+#define SPRITESHEETSPLITTER_APNGENCODER_HPP
+
+#include <vector>
+#include "lodepng.h"
+#include "SpriteEncoder.hpp"
+#include "../../util/CompressionProfile.h"
+
+/**
+ * Writes animated PNGs (APNG, see the PNG specification, third edition), for the frames of a character.
+ *
+ * lodepng has no APNG support, but an APNG is a PNG with more frames: the frames are encoded by SpriteEncoder::encodeFrames
+ * as PNGs that share their color type and palette, and their image data is put together behind the IHDR, PLTE and
+ * ancillary chunks of the first. The first frame is the default image, which viewers without APNG support show.
+ *
+ * Frames are placed at an offset on the canvas, and replace (not blend with) what was there. Nothing is disposed:
+ * a frame smaller than the canvas leaves the rest of the previous frames visible, so the first frame covers the canvas.
+ */
+class ApngEncoder {
+public:
+    struct Frame {
+        SpriteEncoder::Frame image;
+        unsigned x; // offset on the canvas.
+        unsigned y;
+    };
+
+    /**
+     * @param frames the first frame is at offset (0, 0), and as large as the canvas. All of them fit on the canvas.
+     * @param delayMs how long every frame is shown.
+     * @param state encoder state of the sheet, as for SpriteEncoder::encode.
+     * @return error code from lodePNG (0 = OK). 1 if the frames do not fit the rules above.
+     */
+    static unsigned encode(std::vector<unsigned char>& out, const std::vector<Frame>& frames, unsigned delayMs,
+                           lodepng::State& state, CompressionProfile profile, bool reduceColors);
+
+private:
+    static void putChunk(std::vector<unsigned char>& out, const char* type, const unsigned char* data, size_t length);
+    static void putFrameControl(std::vector<unsigned char>& out, unsigned sequence, const Frame& frame, unsigned delayMs);
+};
+
+#endif //SPRITESHEETSPLITTER_APNGENCODER_HPP
@@ -0,0 +1,268 @@
+#include "Checksum.hpp"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include "lodepng.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CHECKSUM_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr uint32_t CRC32_POLYNOMIAL = 0xEDB88320u; // reflected 0x04C11DB7
+constexpr uint32_t ADLER_BASE = 65521u;
+constexpr size_t ADLER_NMAX = 5552; // largest n such that 255n(n+1)/2 + (n+1)(BASE-1) fits in 32 bits.
+
+using CrcFunction = uint32_t (*)(uint32_t, const unsigned char*, size_t);
+using AdlerFunction = uint32_t (*)(uint32_t, const unsigned char*, size_t);
+
+// Slice-by-8 tables: table[k][b] is the CRC of byte b followed by k zero bytes.
+constexpr std::array<std::array<uint32_t, 256>, 8> makeCrcTables() {
+    std::array<std::array<uint32_t, 256>, 8> tables {};
+    for (uint32_t b = 0; b < 256; ++b) {
+        uint32_t crc = b;
+        for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1u) ^ (CRC32_POLYNOMIAL & (0u - (crc & 1u)));
+        tables[0][b] = crc;
+    }
+    for (uint32_t b = 0; b < 256; ++b) {
+        for (size_t k = 1; k < 8; ++k) {
+            tables[k][b] = (tables[k - 1][b] >> 8u) ^ tables[0][tables[k - 1][b] & 0xFFu];
+        }
+    }
+    return tables;
+}
+
+constexpr auto CRC_TABLES = makeCrcTables();
+
+// operates on the inverted crc register, like every CRC32 implementation below.
+uint32_t crc32Portable(uint32_t reg, const unsigned char* data, size_t length) {
+    while (length >= 8) {
+        uint32_t low, high;
+        std::memcpy(&low, data, 4);
+        std::memcpy(&high, data + 4, 4);
+        if constexpr (std::endian::native == std::endian::big) {
+            low = __builtin_bswap32(low);
+            high = __builtin_bswap32(high);
+        }
+        low ^= reg;
+        reg = CRC_TABLES[7][low & 0xFFu] ^ CRC_TABLES[6][(low >> 8u) & 0xFFu] ^
+              CRC_TABLES[5][(low >> 16u) & 0xFFu] ^ CRC_TABLES[4][low >> 24u] ^
+              CRC_TABLES[3][high & 0xFFu] ^ CRC_TABLES[2][(high >> 8u) & 0xFFu] ^
+              CRC_TABLES[1][(high >> 16u) & 0xFFu] ^ CRC_TABLES[0][high >> 24u];
+        data += 8;
+        length -= 8;
+    }
+    while (length--) reg = CRC_TABLES[0][(reg ^ *data++) & 0xFFu] ^ (reg >> 8u);
+    return reg;
+}
+
+uint32_t adler32Portable(uint32_t adler, const unsigned char* data, size_t length) {
+    uint32_t s1 = adler & 0xFFFFu;
+    uint32_t s2 = adler >> 16u;
+    while (length > 0) {
+        size_t n = length < ADLER_NMAX ? length : ADLER_NMAX;
+        length -= n;
+        for (; n >= 8; n -= 8, data += 8) {
+            s1 += data[0]; s2 += s1;
+            s1 += data[1]; s2 += s1;
+            s1 += data[2]; s2 += s1;
+            s1 += data[3]; s2 += s1;
+            s1 += data[4]; s2 += s1;
+            s1 += data[5]; s2 += s1;
+            s1 += data[6]; s2 += s1;
+            s1 += data[7]; s2 += s1;
+        }
+        for (; n > 0; --n) {
+            s1 += *data++;
+            s2 += s1;
+        }
+        s1 %= ADLER_BASE;
+        s2 %= ADLER_BASE;
+    }
+    return (s2 << 16u) | s1;
+}
+
+#ifdef CHECKSUM_X86
+/**
+ * CRC32 by folding 4x128 bits at a time with carry-less multiplication, then Barrett reduction.
+ * Intel, "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" (2009), with the
+ * bit-reflected constants for the PNG/zlib polynomial. Requires length >= 64 and a multiple of 16.
+ */
+__attribute__((target("pclmul,sse4.1")))
+uint32_t crc32Folding(uint32_t reg, const unsigned char* data, size_t length) {
+    alignas(16) static const uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+    alignas(16) static const uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+    alignas(16) static const uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+    alignas(16) static const uint64_t poly[] = {0x01db710641, 0x01f7011641};
+
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20));
+    __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(reg)));
+    __m128i x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+    data += 64;
+    length -= 64;
+
+    // fold 4 lanes in parallel
+    while (length >= 64) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        __m128i x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        __m128i x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        __m128i x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30)));
+        data += 64;
+        length -= 64;
+    }
+
+    // fold the 4 lanes into one
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+    for (__m128i next : {x2, x3, x4}) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, next), x5);
+    }
+
+    // fold the remaining 16 byte blocks
+    while (length >= 16) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data))), x5);
+        data += 16;
+        length -= 16;
+    }
+
+    // 128 -> 64 bits
+    __m128i x2r = _mm_clmulepi64_si128(x1, x0, 0x10);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2r);
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    x2r = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask32);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2r);
+
+    // Barrett reduction to 32 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    x2r = _mm_and_si128(x1, mask32);
+    x2r = _mm_clmulepi64_si128(x2r, x0, 0x10);
+    x2r = _mm_and_si128(x2r, mask32);
+    x2r = _mm_clmulepi64_si128(x2r, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2r);
+
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+uint32_t crc32Accelerated(uint32_t reg, const unsigned char* data, size_t length) {
+    if (length >= 64) {
+        const size_t folded = length & ~size_t(15);
+        reg = crc32Folding(reg, data, folded);
+        data += folded;
+        length -= folded;
+    }
+    return crc32Portable(reg, data, length);
+}
+
+/**
+ * Adler-32 over 32 byte blocks: s1 sums through psadbw, s2 through position weighted pmaddubsw.
+ */
+__attribute__((target("ssse3")))
+uint32_t adler32Accelerated(uint32_t adler, const unsigned char* data, size_t length) {
+    constexpr size_t BLOCK = 32;
+    uint32_t s1 = adler & 0xFFFFu;
+    uint32_t s2 = adler >> 16u;
+
+    size_t blocks = length / BLOCK;
+    length -= blocks * BLOCK;
+
+    const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+
+    while (blocks) {
+        size_t n = ADLER_NMAX / BLOCK;
+        if (n > blocks) n = blocks;
+        blocks -= n;
+
+        // v_ps accumulates s1 once per block: every previous byte is added to s2 once more per 32 bytes.
+        __m128i v_ps = _mm_set_epi32(0, 0, 0, static_cast<int>(s1 * n));
+        __m128i v_s2 = _mm_set_epi32(0, 0, 0, static_cast<int>(s2));
+        __m128i v_s1 = _mm_setzero_si128();
+
+        do {
+            const __m128i bytes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            const __m128i bytes2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+            data += BLOCK;
+        } while (--n);
+
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+        // horizontal sums
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += static_cast<uint32_t>(_mm_cvtsi128_si32(v_s1));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = static_cast<uint32_t>(_mm_cvtsi128_si32(v_s2));
+
+        s1 %= ADLER_BASE;
+        s2 %= ADLER_BASE;
+    }
+
+    return adler32Portable((s2 << 16u) | s1, data, length);
+}
+#endif // CHECKSUM_X86
+
+CrcFunction selectCrc32() {
+#ifdef CHECKSUM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")) return crc32Accelerated;
+#endif
+    return crc32Portable;
+}
+
+AdlerFunction selectAdler32() {
+#ifdef CHECKSUM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3")) return adler32Accelerated;
+#endif
+    return adler32Portable;
+}
+
+} // namespace
+
+// static
+uint32_t Checksum::crc32(uint32_t crc, const unsigned char* data, size_t length) {
+    static const CrcFunction implementation = selectCrc32();
+    return ~implementation(~crc, data, length);
+}
+
+// static
+uint32_t Checksum::adler32(uint32_t adler, const unsigned char* data, size_t length) {
+    static const AdlerFunction implementation = selectAdler32();
+    return implementation(adler, data, length);
+}
+
+/**
+ * lodepng is built with LODEPNG_NO_COMPILE_CRC (see libraries/lodepng/CMakeLists.txt), and links against this definition instead.
+ * Every chunk the decoder reads and the encoder writes goes through here.
+ */
+unsigned lodepng_crc32(const unsigned char* data, size_t length) {
+    return Checksum::crc32(0, data, length);
+}
@@ -0,0 +1,24 @@
+#ifndef SPRITESHEETSPLITTER_CHECKSUM_HPP
+#define SPRITESHEETSPLITTER_CHECKSUM_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The two checksums of the PNG format: CRC32 over every chunk, and Adler-32 over every zlib stream.
+ *
+ * The implementation is picked once at runtime from what the CPU supports:
+ * PCLMULQDQ folding for CRC32 and SSSE3 for Adler-32 on x86, with portable (slice-by-8 / unrolled) fallbacks.
+ *
+ * lodepng picks up crc32 through lodepng_crc32 (the library is built with LODEPNG_NO_COMPILE_CRC),
+ * adler32 is used by the zlib wrapper in Zlib.hpp.
+ */
+class Checksum {
+public:
+    // CRC32 (ISO 3309, as used by PNG) of data[0..length), continuing from a previous result crc. Start with 0.
+    static uint32_t crc32(uint32_t crc, const unsigned char* data, size_t length);
+    // Adler-32 (RFC 1950) of data[0..length), continuing from a previous result adler. Start with 1.
+    static uint32_t adler32(uint32_t adler, const unsigned char* data, size_t length);
+};
+
+#endif //SPRITESHEETSPLITTER_CHECKSUM_HPP
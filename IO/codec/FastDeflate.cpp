@@ -0,0 +1,567 @@
+#include "FastDeflate.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr unsigned MIN_MATCH = 4; // the hash covers 4 bytes, which conveniently is also one RGBA pixel.
+constexpr unsigned MAX_MATCH = 258;
+constexpr unsigned MAX_WINDOW = 32768;
+constexpr unsigned WINDOW_MASK = MAX_WINDOW - 1;
+constexpr unsigned MAX_CHAIN = 16; // candidates visited per position. Deliberately short, speed is the point of this backend.
+constexpr unsigned MIN_HASH_BITS = 8;
+constexpr unsigned MAX_HASH_BITS = 15;
+constexpr size_t MAX_BLOCK_SYMBOLS = 1u << 15;
+constexpr size_t MAX_STORED_LENGTH = 65535;
+
+constexpr unsigned NUM_LITLEN = 286;
+constexpr unsigned NUM_DIST = 30;
+constexpr unsigned NUM_CODELEN = 19;
+constexpr unsigned END_OF_BLOCK = 256;
+
+// RFC 1951, 3.2.5
+constexpr uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                      35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                      3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t DIST_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513,
+                                    769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8,
+                                    8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// RFC 1951, 3.2.7: the order in which the code length code lengths are stored.
+constexpr uint8_t CODELEN_ORDER[NUM_CODELEN] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// Reverse the lowest [bits] bits of code. Huffman codes are packed most significant bit first, everything else LSB first.
+uint16_t reverseBits(unsigned code, unsigned bits) {
+    unsigned reversed = 0;
+    for (unsigned i = 0; i < bits; ++i) {
+        reversed = (reversed << 1u) | (code & 1u);
+        code >>= 1u;
+    }
+    return static_cast<uint16_t>(reversed);
+}
+
+// Canonical Huffman codes (RFC 1951, 3.2.2) from code lengths, already bit-reversed for the LSB-first BitWriter.
+void buildCodes(const unsigned* lengths, unsigned count, uint16_t* codes) {
+    unsigned lengthCount[16] = {0};
+    for (unsigned i = 0; i < count; ++i) lengthCount[lengths[i]]++;
+    lengthCount[0] = 0;
+
+    unsigned nextCode[16] = {0};
+    unsigned code = 0;
+    for (unsigned bits = 1; bits < 16; ++bits) {
+        code = (code + lengthCount[bits - 1]) << 1u;
+        nextCode[bits] = code;
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+        codes[i] = lengths[i] ? reverseBits(nextCode[lengths[i]]++, lengths[i]) : 0;
+    }
+}
+
+/**
+ * Everything about deflate symbols that does not depend on the input: computed once, shared by all threads.
+ */
+struct SymbolTables {
+    uint8_t lengthSymbol[MAX_MATCH + 1]; // match length -> index into LENGTH_BASE (symbol - 257)
+    uint8_t distSymbol[512]; // see distanceSymbol()
+    unsigned fixedLitLengths[288];
+    unsigned fixedDistLengths[32];
+    uint16_t fixedLitCodes[288];
+    uint16_t fixedDistCodes[32];
+
+    SymbolTables() : lengthSymbol(), distSymbol(), fixedLitLengths(), fixedDistLengths(), fixedLitCodes(), fixedDistCodes() {
+        for (unsigned symbol = 0; symbol < 29; ++symbol) {
+            for (unsigned length = LENGTH_BASE[symbol]; length < LENGTH_BASE[symbol] + (1u << LENGTH_EXTRA[symbol]) && length <= MAX_MATCH; ++length) {
+                lengthSymbol[length] = symbol;
+            }
+        }
+        lengthSymbol[MAX_MATCH] = 28; // 258 has its own symbol, rather than 227 + 31.
+
+        for (unsigned symbol = 0; symbol < NUM_DIST; ++symbol) {
+            for (unsigned d = DIST_BASE[symbol] - 1; d < DIST_BASE[symbol] - 1 + (1u << DIST_EXTRA[symbol]); ++d) {
+                if (d < 256) distSymbol[d] = symbol;
+                else distSymbol[256 + (d >> 7u)] = symbol;
+            }
+        }
+
+        // RFC 1951, 3.2.6
+        for (unsigned i = 0; i < 288; ++i) {
+            fixedLitLengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+        }
+        for (unsigned& length : fixedDistLengths) length = 5;
+        buildCodes(fixedLitLengths, 288, fixedLitCodes);
+        buildCodes(fixedDistLengths, 32, fixedDistCodes);
+    }
+
+    // Distances above 256 all have at least 7 extra bits, so (distance - 1) >> 7 identifies their symbol.
+    [[nodiscard]] inline unsigned distanceSymbol(unsigned distance) const {
+        const unsigned d = distance - 1;
+        return d < 256 ? distSymbol[d] : distSymbol[256 + (d >> 7u)];
+    }
+};
+
+const SymbolTables& symbolTables() {
+    static const SymbolTables tables;
+    return tables;
+}
+
+inline uint32_t load32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t load64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Amount of equal leading bytes of a and b, at most maxLength. Both ranges must be readable for maxLength bytes.
+inline unsigned matchLength(const unsigned char* a, const unsigned char* b, unsigned maxLength) {
+    unsigned length = 0;
+#if defined(__SSE2__)
+    while (length + 16 <= maxLength) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + length));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + length));
+        const unsigned differences = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) ^ 0xFFFFu;
+        if (differences) return length + std::countr_zero(differences);
+        length += 16;
+    }
+#endif
+    if constexpr (std::endian::native == std::endian::little) {
+        while (length + 8 <= maxLength) {
+            const uint64_t differences = load64(a + length) ^ load64(b + length);
+            if (differences) return length + std::countr_zero(differences) / 8;
+            length += 8;
+        }
+    }
+    while (length < maxLength && a[length] == b[length]) ++length;
+    return length;
+}
+
+/**
+ * LSB-first bit output into a buffer that is known to be large enough.
+ * Bits collect in a 64-bit register and are written 32 at a time.
+ */
+class BitWriter {
+public:
+    explicit BitWriter(unsigned char* out) : out_(out) {}
+
+    // n <= 32
+    inline void put(uint32_t bits, unsigned n) {
+        buffer_ |= static_cast<uint64_t>(bits) << count_;
+        count_ += n;
+        if (count_ >= 32) {
+            out_[pos_] = static_cast<unsigned char>(buffer_);
+            out_[pos_ + 1] = static_cast<unsigned char>(buffer_ >> 8u);
+            out_[pos_ + 2] = static_cast<unsigned char>(buffer_ >> 16u);
+            out_[pos_ + 3] = static_cast<unsigned char>(buffer_ >> 24u);
+            pos_ += 4;
+            buffer_ >>= 32u;
+            count_ -= 32;
+        }
+    }
+
+    // pad with zero bits up to the next byte boundary, and write out everything still pending.
+    void alignToByte() {
+        while (count_ > 0) {
+            out_[pos_++] = static_cast<unsigned char>(buffer_);
+            buffer_ >>= 8u;
+            count_ = count_ > 8 ? count_ - 8 : 0;
+        }
+        buffer_ = 0;
+    }
+
+    // only valid directly after alignToByte().
+    void putBytes(const unsigned char* bytes, size_t n) {
+        if (n) std::memcpy(out_ + pos_, bytes, n);
+        pos_ += n;
+    }
+
+    [[nodiscard]] size_t bitPosition() const { return pos_ * 8 + count_; }
+    [[nodiscard]] size_t size() const { return pos_; }
+
+private:
+    unsigned char* out_;
+    size_t pos_ = 0;
+    uint64_t buffer_ = 0;
+    unsigned count_ = 0;
+};
+
+// A literal (distance == 0) or a match.
+struct Symbol {
+    uint16_t litlen;
+    uint16_t distance;
+};
+
+struct Match {
+    unsigned length = 0;
+    unsigned distance = 0;
+};
+
+/**
+ * One deflate run. Collects LZ77 symbols per block, then emits the block in its cheapest form.
+ */
+class Deflater {
+public:
+    Deflater(const unsigned char* in, size_t insize, const LodePNGCompressSettings* settings, BitWriter& out)
+        :   in_(in), insize_(insize), settings_(settings), out_(out), tables_(symbolTables()) {}
+
+    unsigned run() {
+        if (settings_->btype == 0) {
+            emitStored(0, insize_, true);
+            return 0;
+        }
+
+        const unsigned window = std::clamp(settings_->windowsize, 1u, MAX_WINDOW);
+        const unsigned niceLength = std::clamp(settings_->nicematch, MIN_MATCH, MAX_MATCH);
+        const bool lazy = settings_->lazymatching != 0;
+        const bool lz77 = settings_->use_lz77 != 0 && insize_ >= MIN_MATCH;
+
+        hashBits_ = std::clamp(static_cast<unsigned>(std::bit_width(insize_)), MIN_HASH_BITS, MAX_HASH_BITS);
+        hashLimit_ = lz77 ? insize_ - MIN_MATCH + 1 : 0;
+        if (lz77) {
+            // scratch is reused between calls of the same thread: sprites are tiny, allocating 192KB per sprite is not.
+            head_.resize(size_t(1) << MAX_HASH_BITS);
+            prev_.resize(MAX_WINDOW);
+            std::fill_n(head_.begin(), size_t(1) << hashBits_, -1);
+        }
+        symbols_.clear();
+        symbols_.reserve(std::min(MAX_BLOCK_SYMBOLS, insize_ + 1));
+        resetFrequencies();
+
+        size_t pos = 0;
+        size_t blockStart = 0;
+        Match pending;
+        bool havePending = false;
+
+        while (pos < insize_) {
+            Match m = havePending ? pending : findAndInsert(pos, window, niceLength);
+            havePending = false;
+
+            if (m.length >= MIN_MATCH && lazy && m.length < niceLength && pos + 1 < hashLimit_) {
+                Match next = findAndInsert(pos + 1, window, niceLength);
+                if (next.length > m.length) {
+                    addLiteral(in_[pos]);
+                    ++pos;
+                    pending = next;
+                    havePending = true;
+                    continue;
+                }
+            }
+
+            if (m.length >= MIN_MATCH) {
+                addMatch(m);
+                pos += m.length;
+                insertUpTo(pos);
+            } else {
+                addLiteral(in_[pos]);
+                ++pos;
+            }
+
+            if (symbols_.size() >= MAX_BLOCK_SYMBOLS) {
+                unsigned error = emitBlock(blockStart, pos, false);
+                if (error) return error;
+                blockStart = pos;
+            }
+        }
+
+        return emitBlock(blockStart, insize_, true);
+    }
+
+private:
+    const unsigned char* in_;
+    const size_t insize_;
+    const LodePNGCompressSettings* settings_;
+    BitWriter& out_;
+    const SymbolTables& tables_;
+
+    unsigned hashBits_ = MIN_HASH_BITS;
+    size_t hashLimit_ = 0; // positions below this have MIN_MATCH readable bytes, and are hashed.
+    size_t nextInsert_ = 0; // positions below this are in the hash chains.
+    unsigned litFreq_[NUM_LITLEN] = {};
+    unsigned distFreq_[NUM_DIST] = {};
+
+    static thread_local std::vector<int32_t> head_;
+    static thread_local std::vector<int32_t> prev_;
+    static thread_local std::vector<Symbol> symbols_;
+
+    inline unsigned hash(size_t pos) const {
+        return (load32(in_ + pos) * 2654435761u) >> (32u - hashBits_);
+    }
+
+    inline int32_t insert(size_t pos) {
+        const unsigned h = hash(pos);
+        const int32_t candidate = head_[h];
+        head_[h] = static_cast<int32_t>(pos);
+        prev_[pos & WINDOW_MASK] = candidate;
+        return candidate;
+    }
+
+    void insertUpTo(size_t end) {
+        end = std::min(end, hashLimit_);
+        for (; nextInsert_ < end; ++nextInsert_) insert(nextInsert_);
+    }
+
+    Match findAndInsert(size_t pos, unsigned window, unsigned niceLength) {
+        Match best;
+        if (pos >= hashLimit_) return best;
+        insertUpTo(pos);
+        int32_t candidate = insert(pos);
+        nextInsert_ = pos + 1;
+
+        const unsigned maxLength = static_cast<unsigned>(std::min<size_t>(MAX_MATCH, insize_ - pos));
+        const unsigned char* current = in_ + pos;
+        for (unsigned chain = MAX_CHAIN; candidate >= 0 && chain != 0; --chain) {
+            const size_t distance = pos - static_cast<size_t>(candidate);
+            if (distance == 0 || distance > window) break;
+
+            const unsigned char* previous = in_ + candidate;
+            // a candidate can only be better if it also matches at the current best length.
+            if (previous[best.length] == current[best.length]) {
+                const unsigned length = matchLength(previous, current, maxLength);
+                if (length > best.length) {
+                    best.length = length;
+                    best.distance = static_cast<unsigned>(distance);
+                    if (length >= niceLength || length == maxLength) break;
+                }
+            }
+            candidate = prev_[static_cast<size_t>(candidate) & WINDOW_MASK];
+        }
+        return best;
+    }
+
+    void resetFrequencies() {
+        std::fill(std::begin(litFreq_), std::end(litFreq_), 0u);
+        std::fill(std::begin(distFreq_), std::end(distFreq_), 0u);
+    }
+
+    inline void addLiteral(unsigned char literal) {
+        symbols_.push_back({literal, 0});
+        litFreq_[literal]++;
+    }
+
+    inline void addMatch(const Match& m) {
+        symbols_.push_back({static_cast<uint16_t>(m.length), static_cast<uint16_t>(m.distance)});
+        litFreq_[257 + tables_.lengthSymbol[m.length]]++;
+        distFreq_[tables_.distanceSymbol(m.distance)]++;
+    }
+
+    void emitStored(size_t start, size_t end, bool final) {
+        size_t pos = start;
+        do {
+            const size_t n = std::min(MAX_STORED_LENGTH, end - pos);
+            const bool last = final && pos + n == end;
+            out_.put(last ? 1u : 0u, 3); // BTYPE 00
+            out_.alignToByte();
+            const unsigned char header[4] = {
+                    static_cast<unsigned char>(n), static_cast<unsigned char>(n >> 8u),
+                    static_cast<unsigned char>(~n), static_cast<unsigned char>(~n >> 8u)};
+            out_.putBytes(header, 4);
+            out_.putBytes(in_ + pos, n);
+            pos += n;
+        } while (pos < end);
+    }
+
+    [[nodiscard]] size_t storedCost(size_t start, size_t end) const {
+        size_t bitPos = out_.bitPosition();
+        size_t pos = start;
+        do {
+            const size_t n = std::min(MAX_STORED_LENGTH, end - pos);
+            bitPos += 3;
+            bitPos = (bitPos + 7) & ~size_t(7);
+            bitPos += 32 + 8 * n;
+            pos += n;
+        } while (pos < end);
+        return bitPos - out_.bitPosition();
+    }
+
+    // bits needed for the symbols of this block, excluding any block header.
+    [[nodiscard]] size_t dataCost(const unsigned* litLengths, const unsigned* distLengths) const {
+        size_t bits = 0;
+        for (unsigned i = 0; i < NUM_LITLEN; ++i) {
+            bits += static_cast<size_t>(litFreq_[i]) * (litLengths[i] + (i > END_OF_BLOCK ? LENGTH_EXTRA[i - 257] : 0u));
+        }
+        for (unsigned i = 0; i < NUM_DIST; ++i) {
+            bits += static_cast<size_t>(distFreq_[i]) * (distLengths[i] + DIST_EXTRA[i]);
+        }
+        return bits;
+    }
+
+    void emitSymbols(const uint16_t* litCodes, const unsigned* litLengths, const uint16_t* distCodes, const unsigned* distLengths) {
+        for (const Symbol& s : symbols_) {
+            if (s.distance == 0) {
+                out_.put(litCodes[s.litlen], litLengths[s.litlen]);
+            } else {
+                const unsigned ls = tables_.lengthSymbol[s.litlen];
+                out_.put(litCodes[257 + ls], litLengths[257 + ls]);
+                if (LENGTH_EXTRA[ls]) out_.put(s.litlen - LENGTH_BASE[ls], LENGTH_EXTRA[ls]);
+                const unsigned ds = tables_.distanceSymbol(s.distance);
+                out_.put(distCodes[ds], distLengths[ds]);
+                if (DIST_EXTRA[ds]) out_.put(s.distance - DIST_BASE[ds], DIST_EXTRA[ds]);
+            }
+        }
+        out_.put(litCodes[END_OF_BLOCK], litLengths[END_OF_BLOCK]);
+    }
+
+    unsigned emitBlock(size_t start, size_t end, bool final) {
+        litFreq_[END_OF_BLOCK] = 1;
+
+        // dynamic Huffman trees for this block
+        unsigned litLengths[NUM_LITLEN];
+        unsigned distLengths[NUM_DIST];
+        unsigned error = lodepng_huffman_code_lengths(litLengths, litFreq_, NUM_LITLEN, 15);
+        if (!error) error = lodepng_huffman_code_lengths(distLengths, distFreq_, NUM_DIST, 15);
+        if (error) return error;
+
+        unsigned hlit = NUM_LITLEN;
+        while (hlit > 257 && litLengths[hlit - 1] == 0) --hlit;
+        unsigned hdist = NUM_DIST;
+        while (hdist > 1 && distLengths[hdist - 1] == 0) --hdist;
+
+        // run length encode the code lengths (RFC 1951, 3.2.7) into (symbol, extra bits value) pairs.
+        unsigned sequence[NUM_LITLEN + NUM_DIST];
+        std::copy_n(litLengths, hlit, sequence);
+        std::copy_n(distLengths, hdist, sequence + hlit);
+        const unsigned sequenceLength = hlit + hdist;
+
+        unsigned rle[NUM_LITLEN + NUM_DIST][2];
+        unsigned rleCount = 0;
+        unsigned clFreq[NUM_CODELEN] = {0};
+        for (unsigned i = 0; i < sequenceLength;) {
+            const unsigned value = sequence[i];
+            unsigned run = 1;
+            while (i + run < sequenceLength && sequence[i + run] == value) ++run;
+            i += run;
+
+            if (value == 0) {
+                while (run >= 11) {
+                    const unsigned r = std::min(run, 138u);
+                    rle[rleCount][0] = 18; rle[rleCount++][1] = r - 11;
+                    run -= r;
+                }
+                if (run >= 3) {
+                    rle[rleCount][0] = 17; rle[rleCount++][1] = run - 3;
+                    run = 0;
+                }
+            } else {
+                rle[rleCount][0] = value; rle[rleCount++][1] = 0;
+                --run;
+                while (run >= 3) {
+                    const unsigned r = std::min(run, 6u);
+                    rle[rleCount][0] = 16; rle[rleCount++][1] = r - 3;
+                    run -= r;
+                }
+            }
+            for (; run > 0; --run) {
+                rle[rleCount][0] = value; rle[rleCount++][1] = 0;
+            }
+        }
+        for (unsigned i = 0; i < rleCount; ++i) clFreq[rle[i][0]]++;
+
+        unsigned clLengths[NUM_CODELEN];
+        error = lodepng_huffman_code_lengths(clLengths, clFreq, NUM_CODELEN, 7);
+        if (error) return error;
+        unsigned hclen = NUM_CODELEN;
+        while (hclen > 4 && clLengths[CODELEN_ORDER[hclen - 1]] == 0) --hclen;
+
+        size_t dynamicCost = 3 + 5 + 5 + 4 + 3 * hclen;
+        for (unsigned i = 0; i < NUM_CODELEN; ++i) dynamicCost += static_cast<size_t>(clFreq[i]) * clLengths[i];
+        dynamicCost += 2 * clFreq[16] + 3 * clFreq[17] + 7 * clFreq[18];
+        dynamicCost += dataCost(litLengths, distLengths);
+
+        const size_t fixedCost = 3 + dataCost(tables_.fixedLitLengths, tables_.fixedDistLengths);
+        const size_t storedBits = storedCost(start, end);
+
+        const bool forceFixed = settings_->btype == 1;
+        if (!forceFixed && storedBits < fixedCost && storedBits < dynamicCost) {
+            emitStored(start, end, final);
+        } else if (forceFixed || fixedCost <= dynamicCost) {
+            out_.put((final ? 1u : 0u) | (1u << 1u), 3);
+            emitSymbols(tables_.fixedLitCodes, tables_.fixedLitLengths, tables_.fixedDistCodes, tables_.fixedDistLengths);
+        } else {
+            uint16_t litCodes[NUM_LITLEN];
+            uint16_t distCodes[NUM_DIST];
+            uint16_t clCodes[NUM_CODELEN];
+            buildCodes(litLengths, NUM_LITLEN, litCodes);
+            buildCodes(distLengths, NUM_DIST, distCodes);
+            buildCodes(clLengths, NUM_CODELEN, clCodes);
+
+            out_.put((final ? 1u : 0u) | (2u << 1u), 3);
+            out_.put(hlit - 257, 5);
+            out_.put(hdist - 1, 5);
+            out_.put(hclen - 4, 4);
+            for (unsigned i = 0; i < hclen; ++i) out_.put(clLengths[CODELEN_ORDER[i]], 3);
+            for (unsigned i = 0; i < rleCount; ++i) {
+                const unsigned symbol = rle[i][0];
+                out_.put(clCodes[symbol], clLengths[symbol]);
+                if (symbol == 16) out_.put(rle[i][1], 2);
+                else if (symbol == 17) out_.put(rle[i][1], 3);
+                else if (symbol == 18) out_.put(rle[i][1], 7);
+            }
+            emitSymbols(litCodes, litLengths, distCodes, distLengths);
+        }
+
+        symbols_.clear();
+        resetFrequencies();
+        return 0;
+    }
+};
+
+thread_local std::vector<int32_t> Deflater::head_;
+thread_local std::vector<int32_t> Deflater::prev_;
+thread_local std::vector<Symbol> Deflater::symbols_;
+
+} // namespace
+
+/**
+ * Compress in[0..insize) into a raw deflate stream.
+ *
+ * When built with SPLITTER_VERIFY_CODECS, every produced stream is decoded again with lodepng's own inflate
+ * and compared to the input. A mismatch is reported as an error, which lodepng surfaces as its error 111.
+ *
+ * @return 0 on success, a non-zero error code otherwise.
+ */
+// static
+unsigned FastDeflate::deflate(unsigned char** out, size_t* outsize, const unsigned char* in, size_t insize, const LodePNGCompressSettings* settings) {
+    // Every block is emitted in its cheapest form, so it is never larger than stored. Fixed Huffman (btype 1) is at most 9 bits per byte.
+    const size_t bound = insize + insize / 8 + 6 * (insize / 16384 + 2) + 16;
+    auto* buffer = static_cast<unsigned char*>(std::malloc(bound));
+    if (!buffer) return 83; // same meaning as lodepng: alloc fail
+
+    BitWriter writer(buffer);
+    Deflater deflater(in, insize, settings, writer);
+    unsigned error = deflater.run();
+    writer.alignToByte();
+
+    if (error) {
+        std::free(buffer);
+        return error;
+    }
+
+#ifdef SPLITTER_VERIFY_CODECS
+    unsigned char* check = nullptr;
+    size_t checkSize = 0;
+    unsigned verifyError = lodepng_inflate(&check, &checkSize, buffer, writer.size(), &lodepng_default_decompress_settings);
+    bool identical = !verifyError && checkSize == insize && (insize == 0 || 0 == std::memcmp(check, in, insize));
+    std::free(check);
+    if (!identical) {
+        std::free(buffer);
+        return 1;
+    }
+#endif
+
+    *out = buffer;
+    *outsize = writer.size();
+    return 0;
+}
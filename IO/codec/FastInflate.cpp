@@ -0,0 +1,534 @@
+#include "FastInflate.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr unsigned MAX_CODE_BITS = 15;
+constexpr unsigned MAX_MATCH = 258;
+// Matches and literal pairs are written in whole 8/16 byte words, which may run this far past their end.
+constexpr size_t OUT_SLACK = 32;
+
+constexpr unsigned NUM_LITLEN = 288;
+constexpr unsigned NUM_DIST = 32;
+constexpr unsigned NUM_CODELEN = 19;
+
+// Codes up to this many bits are resolved with one lookup. Longer ones go through a second level table.
+constexpr unsigned LITLEN_TABLE_BITS = 11;
+constexpr unsigned DIST_TABLE_BITS = 8;
+constexpr unsigned CODELEN_TABLE_BITS = 7; // code length codes are at most 7 bits, never needs a second level.
+
+// Worst case: every long code gets a second level table of its own, sized for the longest code.
+constexpr unsigned LITLEN_TABLE_SIZE = (1u << LITLEN_TABLE_BITS) + NUM_LITLEN * (1u << (MAX_CODE_BITS - LITLEN_TABLE_BITS));
+constexpr unsigned DIST_TABLE_SIZE = (1u << DIST_TABLE_BITS) + NUM_DIST * (1u << (MAX_CODE_BITS - DIST_TABLE_BITS));
+
+// the error codes are lodepng's, for whoever reads them in a debugger: lodepng itself translates them to 110.
+constexpr unsigned ERROR_REPEAT_PAST_END = 13;
+constexpr unsigned ERROR_INVALID_SYMBOL = 16;
+constexpr unsigned ERROR_INVALID_DISTANCE_SYMBOL = 18;
+constexpr unsigned ERROR_BTYPE = 20;
+constexpr unsigned ERROR_NLEN = 21;
+constexpr unsigned ERROR_STORED_PAST_END = 23;
+constexpr unsigned ERROR_STORED_HEADER_PAST_END = 52;
+constexpr unsigned ERROR_PAST_END = 51;
+constexpr unsigned ERROR_DISTANCE = 52;
+constexpr unsigned ERROR_REPEAT_FIRST = 54;
+constexpr unsigned ERROR_OVERSUBSCRIBED = 55;
+constexpr unsigned ERROR_NO_END_CODE = 64;
+constexpr unsigned ERROR_ALLOC = 83;
+constexpr unsigned ERROR_MAX_OUTPUT = 109;
+
+// RFC 1951, 3.2.5
+constexpr uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                      35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                      3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t DIST_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513,
+                                    769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8,
+                                    8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// RFC 1951, 3.2.7: the order in which the code length code lengths are stored.
+constexpr uint8_t CODELEN_ORDER[NUM_CODELEN] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+/**
+ * A decode table entry, packed into 32 bits:
+ * bits 0-4: bits of input it consumes (the code, or both codes of a literal pair; the full length for second level entries)
+ * bits 5-7: its Kind
+ * bits 8-11: extra bits that follow the code (lengths and distances), or the index bits of a second level table
+ * bits 16-31: the value: literal(s), base length/distance, or the offset of the second level table
+ */
+enum Kind : uint32_t {
+    LITERAL = 0,
+    LITERAL_PAIR = 1,
+    BASE = 2, // length or distance
+    END_OF_BLOCK = 3,
+    SUBTABLE = 4,
+    INVALID = 5,
+};
+
+constexpr uint32_t makeEntry(Kind kind, uint32_t value, uint32_t extraBits = 0, uint32_t codeBits = 0) {
+    return codeBits | (static_cast<uint32_t>(kind) << 5u) | (extraBits << 8u) | (value << 16u);
+}
+
+inline unsigned entryBits(uint32_t entry) { return entry & 31u; }
+inline unsigned entryKind(uint32_t entry) { return (entry >> 5u) & 7u; }
+inline unsigned entryExtra(uint32_t entry) { return (entry >> 8u) & 15u; }
+inline unsigned entryValue(uint32_t entry) { return entry >> 16u; }
+
+// Reverse the lowest [bits] bits of code. Huffman codes are packed most significant bit first, everything else LSB first.
+unsigned reverseBits(unsigned code, unsigned bits) {
+    unsigned reversed = 0;
+    for (unsigned i = 0; i < bits; ++i) {
+        reversed = (reversed << 1u) | (code & 1u);
+        code >>= 1u;
+    }
+    return reversed;
+}
+
+/**
+ * Build a two level decode table for the canonical Huffman code (RFC 1951, 3.2.2) given by its code lengths.
+ * Like lodepng, only codes of zero or one symbol may be incomplete: their unused bit patterns decode as INVALID.
+ * @param symbolEntries per symbol, the entry to decode it to (without the code bits, which are filled in here).
+ * @return false if the code is over-subscribed, or incomplete with more than one symbol.
+ */
+bool buildTable(uint32_t* table, unsigned tableBits, const uint8_t* lengths, unsigned count, const uint32_t* symbolEntries) {
+    unsigned lengthCount[MAX_CODE_BITS + 1] = {0};
+    for (unsigned i = 0; i < count; ++i) lengthCount[lengths[i]]++;
+    lengthCount[0] = 0;
+
+    int left = 1;
+    unsigned maxBits = 0;
+    unsigned numSymbols = 0;
+    for (unsigned bits = 1; bits <= MAX_CODE_BITS; ++bits) {
+        left = 2 * left - static_cast<int>(lengthCount[bits]);
+        if (left < 0) return false;
+        if (lengthCount[bits]) maxBits = bits;
+        numSymbols += lengthCount[bits];
+    }
+    if (left > 0 && numSymbols > 1) return false;
+
+    unsigned nextCode[MAX_CODE_BITS + 1] = {0};
+    unsigned code = 0;
+    for (unsigned bits = 1; bits <= MAX_CODE_BITS; ++bits) {
+        code = (code + lengthCount[bits - 1]) << 1u;
+        nextCode[bits] = code;
+    }
+
+    const unsigned primarySize = 1u << tableBits;
+    const unsigned subBits = maxBits > tableBits ? maxBits - tableBits : 0;
+    const unsigned subSize = 1u << subBits;
+    const uint32_t invalid = makeEntry(INVALID, 0);
+    for (unsigned i = 0; i < primarySize; ++i) table[i] = invalid;
+    unsigned nextSubtable = primarySize;
+
+    for (unsigned symbol = 0; symbol < count; ++symbol) {
+        const unsigned bits = lengths[symbol];
+        if (!bits) continue;
+        const unsigned reversed = reverseBits(nextCode[bits]++, bits);
+        const uint32_t entry = symbolEntries[symbol] | bits;
+
+        if (bits <= tableBits) {
+            for (unsigned i = reversed; i < primarySize; i += 1u << bits) table[i] = entry;
+            continue;
+        }
+
+        uint32_t& link = table[reversed & (primarySize - 1)];
+        if (entryKind(link) != SUBTABLE) {
+            link = makeEntry(SUBTABLE, nextSubtable, subBits);
+            for (unsigned i = 0; i < subSize; ++i) table[nextSubtable + i] = invalid;
+            nextSubtable += subSize;
+        }
+        uint32_t* subtable = table + entryValue(link);
+        for (unsigned i = reversed >> tableBits; i < subSize; i += 1u << (bits - tableBits)) subtable[i] = entry;
+    }
+    return true;
+}
+
+/**
+ * Merge literals that fit in one lookup together with the literal following them into LITERAL_PAIR entries.
+ * Going down from the top, table[i >> bits] is always still a single-symbol entry when it is read.
+ */
+void pairLiterals(uint32_t* table, unsigned tableBits) {
+    for (unsigned i = (1u << tableBits); i-- > 0;) {
+        const uint32_t first = table[i];
+        const unsigned firstBits = entryBits(first);
+        if (entryKind(first) != LITERAL || firstBits >= tableBits) continue;
+
+        const uint32_t second = table[i >> firstBits];
+        const unsigned secondBits = entryBits(second);
+        if (entryKind(second) != LITERAL || firstBits + secondBits > tableBits) continue;
+
+        table[i] = makeEntry(LITERAL_PAIR, entryValue(first) | (entryValue(second) << 8u), 0, firstBits + secondBits);
+    }
+}
+
+/**
+ * What each literal/length and distance symbol decodes to, and the tables for the fixed Huffman code (RFC 1951, 3.2.6).
+ * Computed once, shared by all threads.
+ */
+struct SymbolTables {
+    uint32_t litLenEntries[NUM_LITLEN];
+    uint32_t distEntries[NUM_DIST];
+    uint32_t codeLenEntries[NUM_CODELEN];
+    uint32_t fixedLitLen[LITLEN_TABLE_SIZE];
+    uint32_t fixedDist[DIST_TABLE_SIZE];
+
+    SymbolTables() : litLenEntries(), distEntries(), codeLenEntries(), fixedLitLen(), fixedDist() {
+        for (unsigned symbol = 0; symbol < 256; ++symbol) litLenEntries[symbol] = makeEntry(LITERAL, symbol);
+        litLenEntries[256] = makeEntry(END_OF_BLOCK, 0);
+        for (unsigned symbol = 257; symbol < 286; ++symbol) {
+            litLenEntries[symbol] = makeEntry(BASE, LENGTH_BASE[symbol - 257], LENGTH_EXTRA[symbol - 257]);
+        }
+        litLenEntries[286] = litLenEntries[287] = makeEntry(INVALID, 0);
+
+        for (unsigned symbol = 0; symbol < 30; ++symbol) distEntries[symbol] = makeEntry(BASE, DIST_BASE[symbol], DIST_EXTRA[symbol]);
+        distEntries[30] = distEntries[31] = makeEntry(INVALID, 0);
+
+        for (unsigned symbol = 0; symbol < NUM_CODELEN; ++symbol) codeLenEntries[symbol] = makeEntry(LITERAL, symbol);
+
+        uint8_t lengths[NUM_LITLEN];
+        for (unsigned i = 0; i < NUM_LITLEN; ++i) lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+        buildTable(fixedLitLen, LITLEN_TABLE_BITS, lengths, NUM_LITLEN, litLenEntries);
+        pairLiterals(fixedLitLen, LITLEN_TABLE_BITS);
+        for (unsigned i = 0; i < NUM_DIST; ++i) lengths[i] = 5;
+        buildTable(fixedDist, DIST_TABLE_BITS, lengths, NUM_DIST, distEntries);
+    }
+};
+
+const SymbolTables& symbolTables() {
+    static const SymbolTables tables;
+    return tables;
+}
+
+inline uint64_t load64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v; // little endian assumed, like everywhere else in the codecs.
+}
+
+/**
+ * One inflate call: the bit reader, the output buffer and the per-block decode tables.
+ */
+class Inflater {
+public:
+    Inflater(unsigned char* out, size_t outSize, const unsigned char* in, size_t insize, const LodePNGDecompressSettings* settings)
+            : in_(in), inEnd_(in + insize), out_(out), pos_(outSize), capacity_(outSize), settings_(settings) {}
+
+    [[nodiscard]] unsigned char* data() const { return out_; }
+    [[nodiscard]] size_t size() const { return pos_; }
+
+    unsigned run(size_t expectedSize) {
+        // room for the last match too, so that a correct hint never makes the buffer grow.
+        unsigned error = reserve(pos_ + expectedSize + MAX_MATCH);
+
+        bool finalBlock = false;
+        while (!error && !finalBlock) {
+            refill();
+            finalBlock = readBits(1);
+            const unsigned blockType = readBits(2);
+            if (consumedPadding()) {
+                error = ERROR_STORED_HEADER_PAST_END; // what lodepng reports for a missing block header, too.
+                break;
+            }
+
+            if (blockType == 0) {
+                error = inflateStored();
+            } else if (blockType == 1) {
+                const SymbolTables& tables = symbolTables();
+                error = inflateHuffman(tables.fixedLitLen, tables.fixedDist);
+            } else if (blockType == 2) {
+                error = readDynamicTables();
+                if (!error) error = inflateHuffman(litLen_, dist_);
+            } else {
+                error = ERROR_BTYPE;
+            }
+
+            if (!error && settings_->max_output_size && pos_ > settings_->max_output_size) error = ERROR_MAX_OUTPUT;
+        }
+        return error;
+    }
+
+private:
+    const unsigned char* in_;
+    const unsigned char* const inEnd_;
+    uint64_t bitBuffer_ = 0;
+    unsigned bitCount_ = 0;
+    unsigned overread_ = 0; // zero bytes appended past the end of the input
+
+    unsigned char* out_;
+    size_t pos_;
+    size_t capacity_;
+    const LodePNGDecompressSettings* settings_;
+
+    static thread_local uint32_t litLen_[LITLEN_TABLE_SIZE];
+    static thread_local uint32_t dist_[DIST_TABLE_SIZE];
+
+    /**
+     * Top the bit buffer up to at least 56 bits. Enough for a length code, its extra bits, a distance code and its extra bits.
+     * Away from the end of the input, this is one unaligned load without any branch on how many bits were left.
+     * The bits above bitCount_ are then the next bits of the input rather than zero, so OR-ing the same bytes in again later is harmless.
+     */
+    inline void refill() {
+        if (inEnd_ - in_ >= 8) {
+            bitBuffer_ |= load64(in_) << bitCount_;
+            in_ += (63u - bitCount_) >> 3u;
+            bitCount_ |= 56u;
+        } else {
+            while (bitCount_ < 56) {
+                if (in_ < inEnd_) bitBuffer_ |= static_cast<uint64_t>(*in_++) << bitCount_;
+                else ++overread_;
+                bitCount_ += 8;
+            }
+        }
+    }
+
+    inline unsigned peekBits(unsigned count) const {
+        return static_cast<unsigned>(bitBuffer_ & ((uint64_t(1) << count) - 1));
+    }
+
+    inline void consume(unsigned count) {
+        bitBuffer_ >>= count;
+        bitCount_ -= count;
+    }
+
+    inline unsigned readBits(unsigned count) {
+        const unsigned bits = peekBits(count);
+        consume(count);
+        return bits;
+    }
+
+    [[nodiscard]] bool consumedPadding() const {
+        return overread_ * 8u > bitCount_;
+    }
+
+    inline uint32_t lookup(const uint32_t* table, unsigned tableBits) const {
+        uint32_t entry = table[peekBits(tableBits)];
+        if (entryKind(entry) == SUBTABLE) {
+            entry = table[entryValue(entry) + static_cast<unsigned>((bitBuffer_ >> tableBits) & ((1u << entryExtra(entry)) - 1))];
+        }
+        return entry;
+    }
+
+    // Make room for [size] bytes of output plus the slack wide copies need.
+    unsigned reserve(size_t size) {
+        if (size + OUT_SLACK <= capacity_) return 0;
+        if (settings_->max_output_size && pos_ > settings_->max_output_size) return ERROR_MAX_OUTPUT;
+
+        size_t newCapacity = capacity_ * 2;
+        if (newCapacity < size + OUT_SLACK) newCapacity = size + OUT_SLACK;
+        auto* grown = static_cast<unsigned char*>(std::realloc(out_, newCapacity));
+        if (!grown) return ERROR_ALLOC;
+        out_ = grown;
+        capacity_ = newCapacity;
+        return 0;
+    }
+
+    unsigned inflateStored() {
+        // back to the byte boundary, and hand the whole bytes still in the bit buffer back to the input.
+        consume(bitCount_ & 7u);
+        unsigned buffered = bitCount_ >> 3u;
+        if (overread_ > buffered) return ERROR_PAST_END;
+        in_ -= buffered - overread_;
+        overread_ = 0;
+        bitBuffer_ = 0;
+        bitCount_ = 0;
+
+        if (inEnd_ - in_ < 4) return ERROR_STORED_HEADER_PAST_END;
+        const unsigned length = in_[0] | (in_[1] << 8u);
+        const unsigned nlength = in_[2] | (in_[3] << 8u);
+        in_ += 4;
+        if (!settings_->ignore_nlen && length + nlength != 65535) return ERROR_NLEN;
+        if (static_cast<size_t>(inEnd_ - in_) < length) return ERROR_STORED_PAST_END;
+
+        if (unsigned error = reserve(pos_ + length)) return error;
+        if (length) std::memcpy(out_ + pos_, in_, length);
+        pos_ += length;
+        in_ += length;
+        return 0;
+    }
+
+    unsigned readDynamicTables() {
+        const SymbolTables& tables = symbolTables();
+        // 14 header bits and up to 19 * 3 code length bits: 71 bits, so one refill halfway.
+        const unsigned numLitLen = readBits(5) + 257;
+        const unsigned numDist = readBits(5) + 1;
+        const unsigned numCodeLen = readBits(4) + 4;
+
+        uint8_t codeLenLengths[NUM_CODELEN] = {0};
+        for (unsigned i = 0; i < numCodeLen; ++i) {
+            if (i == 10) refill();
+            codeLenLengths[CODELEN_ORDER[i]] = static_cast<uint8_t>(readBits(3));
+        }
+        uint32_t codeLenTable[1u << CODELEN_TABLE_BITS];
+        if (!buildTable(codeLenTable, CODELEN_TABLE_BITS, codeLenLengths, NUM_CODELEN, tables.codeLenEntries)) return ERROR_OVERSUBSCRIBED;
+
+        uint8_t lengths[NUM_LITLEN + NUM_DIST] = {0};
+        const unsigned total = numLitLen + numDist;
+        unsigned i = 0;
+        while (i < total) {
+            // checked per symbol, like lodepng does: reading the stream past its end never goes further than one symbol.
+            if (consumedPadding()) return ERROR_PAST_END;
+            refill();
+
+            const uint32_t entry = codeLenTable[peekBits(CODELEN_TABLE_BITS)];
+            if (entryKind(entry) == INVALID) return ERROR_INVALID_SYMBOL;
+            consume(entryBits(entry));
+            const unsigned symbol = entryValue(entry);
+
+            if (symbol < 16) {
+                lengths[i++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+
+            unsigned repeat;
+            uint8_t value = 0;
+            if (symbol == 16) {
+                if (i == 0) return ERROR_REPEAT_FIRST;
+                repeat = 3 + readBits(2);
+                value = lengths[i - 1];
+            } else if (symbol == 17) {
+                repeat = 3 + readBits(3);
+            } else {
+                repeat = 11 + readBits(7);
+            }
+            if (i + repeat > total) return ERROR_REPEAT_PAST_END;
+            std::memset(lengths + i, value, repeat);
+            i += repeat;
+        }
+        if (consumedPadding()) return ERROR_PAST_END;
+        if (lengths[256] == 0) return ERROR_NO_END_CODE;
+
+        // the distance lengths are copied out, so that both codes are zero padded to their full symbol count.
+        uint8_t distLengths[NUM_DIST] = {0};
+        std::memcpy(distLengths, lengths + numLitLen, numDist);
+        std::memset(lengths + numLitLen, 0, numDist);
+
+        if (!buildTable(litLen_, LITLEN_TABLE_BITS, lengths, NUM_LITLEN, tables.litLenEntries)) return ERROR_OVERSUBSCRIBED;
+        if (!buildTable(dist_, DIST_TABLE_BITS, distLengths, NUM_DIST, tables.distEntries)) return ERROR_OVERSUBSCRIBED;
+        pairLiterals(litLen_, LITLEN_TABLE_BITS);
+        return 0;
+    }
+
+    unsigned inflateHuffman(const uint32_t* litLenTable, const uint32_t* distTable) {
+        for (;;) {
+            // like lodepng, an end of block code may run into the padding past the end of the input, nothing else may.
+            if (consumedPadding()) return ERROR_PAST_END;
+            refill();
+            if (pos_ + MAX_MATCH + OUT_SLACK > capacity_) {
+                if (unsigned error = reserve(pos_ + MAX_MATCH)) return error;
+            }
+
+            const uint32_t entry = lookup(litLenTable, LITLEN_TABLE_BITS);
+            consume(entryBits(entry));
+
+            switch (entryKind(entry)) {
+                case LITERAL:
+                    out_[pos_++] = static_cast<unsigned char>(entryValue(entry));
+                    continue;
+                case LITERAL_PAIR: {
+                    const auto pair = static_cast<uint16_t>(entryValue(entry));
+                    std::memcpy(out_ + pos_, &pair, 2);
+                    pos_ += 2;
+                    continue;
+                }
+                case BASE:
+                    break;
+                case END_OF_BLOCK:
+                    return 0;
+                default:
+                    return ERROR_INVALID_SYMBOL;
+            }
+
+            const unsigned length = entryValue(entry) + readBits(entryExtra(entry));
+
+            const uint32_t distEntry = lookup(distTable, DIST_TABLE_BITS);
+            if (entryKind(distEntry) != BASE) return ERROR_INVALID_DISTANCE_SYMBOL;
+            consume(entryBits(distEntry));
+            const size_t distance = entryValue(distEntry) + readBits(entryExtra(distEntry));
+            if (distance > pos_) return ERROR_DISTANCE;
+
+            copyMatch(out_ + pos_, distance, length);
+            pos_ += length;
+        }
+    }
+
+    /**
+     * Copy [length] bytes from [distance] bytes back, in whole words: may write up to OUT_SLACK bytes past the match.
+     * When the match overlaps itself by less than a word, the repeating pattern is written instead.
+     */
+    static inline void copyMatch(unsigned char* dst, size_t distance, unsigned length) {
+        const unsigned char* src = dst - distance;
+        unsigned char* const end = dst + length;
+
+        if (distance >= 16) {
+            do {
+                std::memcpy(dst, src, 16);
+                dst += 16;
+                src += 16;
+            } while (dst < end);
+        } else if (distance >= 8) {
+            do {
+                std::memcpy(dst, src, 8);
+                dst += 8;
+                src += 8;
+            } while (dst < end);
+        } else if (distance == 1) {
+            std::memset(dst, *src, length);
+        } else {
+            // e.g. a run of one RGBA pixel: distance 4, pattern ABCDABCD, written 8 bytes at a time.
+            unsigned char pattern[8];
+            for (unsigned i = 0; i < 8; ++i) pattern[i] = src[i % distance];
+            const size_t step = 8 - 8 % distance;
+            do {
+                std::memcpy(dst, pattern, 8);
+                dst += step;
+            } while (dst < end);
+        }
+    }
+};
+
+thread_local uint32_t Inflater::litLen_[LITLEN_TABLE_SIZE];
+thread_local uint32_t Inflater::dist_[DIST_TABLE_SIZE];
+
+} // namespace
+
+/**
+ * Decompress the deflate stream in[0..insize), appending to *out.
+ *
+ * When settings->custom_context is set, it must point to a FastInflate::SizeHint.
+ * When built with SPLITTER_VERIFY_CODECS, every result is compared against lodepng's own inflate of the same stream.
+ * A mismatch is reported as an error, which lodepng surfaces as its error 110.
+ *
+ * @return 0 on success, a non-zero error code otherwise.
+ */
+// static
+unsigned FastInflate::inflate(unsigned char** out, size_t* outsize, const unsigned char* in, size_t insize, const LodePNGDecompressSettings* settings) {
+    const auto* hint = static_cast<const SizeHint*>(settings->custom_context);
+    size_t expectedSize = hint ? hint->expectedSize : insize * 4; // without a hint, assume a typical PNG ratio and grow from there.
+    if (settings->max_output_size && expectedSize > settings->max_output_size) expectedSize = settings->max_output_size;
+
+#ifdef SPLITTER_VERIFY_CODECS
+    const size_t previousSize = *outsize;
+#endif
+
+    Inflater inflater(*out, *outsize, in, insize, settings);
+    unsigned error = inflater.run(expectedSize);
+    *out = inflater.data();
+    *outsize = inflater.size();
+
+#ifdef SPLITTER_VERIFY_CODECS
+    unsigned char* check = nullptr;
+    size_t checkSize = 0;
+    LodePNGDecompressSettings checkSettings = *settings;
+    checkSettings.custom_inflate = nullptr;
+    checkSettings.custom_context = nullptr;
+    const unsigned verifyError = lodepng_inflate(&check, &checkSize, in, insize, &checkSettings);
+    if ((verifyError == 0) != (error == 0)) error = 1;
+    if (!error && (checkSize != *outsize - previousSize || std::memcmp(check, *out + previousSize, checkSize) != 0)) error = 1;
+    std::free(check);
+#endif
+
+    return error;
+}
@@ -0,0 +1,33 @@
+#ifndef SPRITESHEETSPLITTER_FASTINFLATE_HPP
+#define SPRITESHEETSPLITTER_FASTINFLATE_HPP
+
+#include "lodepng.h"
+
+/**
+ * In-tree inflate (RFC 1951) decompressor, plugged into lodepng through LodePNGDecompressSettings::custom_inflate.
+ *
+ * Compared to lodepng's built-in inflate:
+ * Huffman codes are decoded through lookup tables that resolve most codes (and most pairs of literals) in a single probe,
+ * bits come from a 64-bit buffer that is refilled without branching on the input position,
+ * and matches are copied 8 or 16 bytes at a time, overlapping ones by repeating their pattern.
+ *
+ * Honoured decompress settings: ignore_nlen, max_output_size.
+ * Like lodepng_inflate, the output is appended to *out.
+ */
+class FastInflate {
+public:
+    /**
+     * Optional LodePNGDecompressSettings::custom_context: the exact size the stream decompresses to,
+     * so the output is allocated once instead of grown. A wrong hint only costs speed.
+     */
+    struct SizeHint {
+        size_t expectedSize;
+    };
+
+    // Signature of LodePNGDecompressSettings::custom_inflate. The output is allocated with malloc, as lodepng expects.
+    static unsigned inflate(unsigned char** out, size_t* outsize,
+                            const unsigned char* in, size_t insize,
+                            const LodePNGDecompressSettings* settings);
+};
+
+#endif //SPRITESHEETSPLITTER_FASTINFLATE_HPP
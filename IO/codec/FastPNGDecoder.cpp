@@ -0,0 +1,341 @@
+#include "FastPNGDecoder.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "FastInflate.hpp"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr unsigned BYTES_PER_PIXEL = 4;
+
+// the error codes are lodepng's, so that callers (and lodepng_error_text) cannot tell the decoders apart.
+constexpr unsigned ERROR_CHUNK_PAST_END = 30;
+constexpr unsigned ERROR_UNFILTER_TYPE = 36;
+constexpr unsigned ERROR_CRC = 57;
+constexpr unsigned ERROR_CHUNK_LENGTH = 63;
+constexpr unsigned ERROR_CHUNK_DATA_PAST_END = 64;
+constexpr unsigned ERROR_UNKNOWN_CRITICAL = 69;
+constexpr unsigned ERROR_SIZE_MISMATCH = 91;
+constexpr unsigned ERROR_OVERFLOW = 92;
+constexpr unsigned ERROR_CUSTOM_ZLIB = 110;
+
+bool isRGBA8(const LodePNGColorMode& mode) {
+    return mode.colortype == LCT_RGBA && mode.bitdepth == 8;
+}
+
+#if defined(__SSE2__)
+inline __m128i load4(const unsigned char* p) {
+    int v;
+    std::memcpy(&v, p, 4);
+    return _mm_cvtsi32_si128(v);
+}
+
+inline void store4(unsigned char* p, __m128i v) {
+    int x = _mm_cvtsi128_si32(v);
+    std::memcpy(p, &x, 4);
+}
+
+inline __m128i ifThenElse(__m128i condition, __m128i then, __m128i otherwise) {
+    return _mm_or_si128(_mm_and_si128(condition, then), _mm_andnot_si128(condition, otherwise));
+}
+
+inline __m128i abs16(__m128i x) {
+    return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+// Sub: a running sum over pixels. 4 pixels at a time, as a log-step prefix sum plus the carry of the previous group.
+void unfilterSub(unsigned char* recon, const unsigned char* scanline, size_t length) {
+    __m128i carry = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(scanline + i));
+        x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+        x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi8(x, carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(recon + i), x);
+        carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    for (; i < length; i += BYTES_PER_PIXEL) {
+        carry = _mm_add_epi8(carry, load4(scanline + i));
+        store4(recon + i, carry);
+    }
+}
+
+void unfilterUp(unsigned char* recon, const unsigned char* scanline, const unsigned char* precon, size_t length) {
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(scanline + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(precon + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(recon + i), _mm_add_epi8(x, b));
+    }
+    for (; i < length; ++i) recon[i] = static_cast<unsigned char>(scanline[i] + precon[i]);
+}
+
+// Average: pavgb rounds up, so subtract the lost bit to get floor((a + b) / 2). Sequential per pixel.
+void unfilterAverage(unsigned char* recon, const unsigned char* scanline, const unsigned char* precon, size_t length) {
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i a = _mm_setzero_si128();
+    for (size_t i = 0; i < length; i += BYTES_PER_PIXEL) {
+        const __m128i b = load4(precon + i);
+        __m128i average = _mm_avg_epu8(a, b);
+        average = _mm_sub_epi8(average, _mm_and_si128(_mm_xor_si128(a, b), one));
+        a = _mm_add_epi8(load4(scanline + i), average);
+        store4(recon + i, a);
+    }
+}
+
+// Paeth in 16-bit lanes, one pixel at a time. Ties are broken towards a, then b, then c as the specification demands.
+void unfilterPaeth(unsigned char* recon, const unsigned char* scanline, const unsigned char* precon, size_t length) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = zero; // left
+    __m128i c = zero; // up-left
+    for (size_t i = 0; i < length; i += BYTES_PER_PIXEL) {
+        const __m128i b = _mm_unpacklo_epi8(load4(precon + i), zero);
+        const __m128i pa = _mm_sub_epi16(b, c);
+        const __m128i pb = _mm_sub_epi16(a, c);
+        const __m128i pc = abs16(_mm_add_epi16(pa, pb));
+        const __m128i absA = abs16(pa);
+        const __m128i absB = abs16(pb);
+        const __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(absA, absB));
+        const __m128i nearest = ifThenElse(_mm_cmpeq_epi16(smallest, absA), a,
+                                           ifThenElse(_mm_cmpeq_epi16(smallest, absB), b, c));
+        const __m128i x = _mm_add_epi8(load4(scanline + i), _mm_packus_epi16(nearest, nearest));
+        store4(recon + i, x);
+        a = _mm_unpacklo_epi8(x, zero);
+        c = b;
+    }
+}
+#else
+inline unsigned char paethPredictor(int a, int b, int c) {
+    const int pa = std::abs(b - c);
+    const int pb = std::abs(a - c);
+    const int pc = std::abs(a + b - 2 * c);
+    if (pc < pa && pc < pb) return static_cast<unsigned char>(c);
+    if (pb < pa) return static_cast<unsigned char>(b);
+    return static_cast<unsigned char>(a);
+}
+
+void unfilterSub(unsigned char* recon, const unsigned char* scanline, size_t length) {
+    for (size_t i = 0; i < BYTES_PER_PIXEL && i < length; ++i) recon[i] = scanline[i];
+    for (size_t i = BYTES_PER_PIXEL; i < length; ++i) recon[i] = static_cast<unsigned char>(scanline[i] + recon[i - BYTES_PER_PIXEL]);
+}
+
+void unfilterUp(unsigned char* recon, const unsigned char* scanline, const unsigned char* precon, size_t length) {
+    for (size_t i = 0; i < length; ++i) recon[i] = static_cast<unsigned char>(scanline[i] + precon[i]);
+}
+
+void unfilterAverage(unsigned char* recon, const unsigned char* scanline, const unsigned char* precon, size_t length) {
+    for (size_t i = 0; i < BYTES_PER_PIXEL && i < length; ++i) recon[i] = static_cast<unsigned char>(scanline[i] + (precon[i] >> 1u));
+    for (size_t i = BYTES_PER_PIXEL; i < length; ++i) {
+        recon[i] = static_cast<unsigned char>(scanline[i] + ((recon[i - BYTES_PER_PIXEL] + precon[i]) >> 1u));
+    }
+}
+
+void unfilterPaeth(unsigned char* recon, const unsigned char* scanline, const unsigned char* precon, size_t length) {
+    for (size_t i = 0; i < BYTES_PER_PIXEL && i < length; ++i) recon[i] = static_cast<unsigned char>(scanline[i] + precon[i]);
+    for (size_t i = BYTES_PER_PIXEL; i < length; ++i) {
+        recon[i] = static_cast<unsigned char>(scanline[i] + paethPredictor(recon[i - BYTES_PER_PIXEL], precon[i], precon[i - BYTES_PER_PIXEL]));
+    }
+}
+#endif
+
+} // namespace
+
+/**
+ * Decode a PNG in memory, see lodepng::decode.
+ * Takes the fast path when both the PNG and state.info_raw are 8-bit RGBA and the PNG is not interlaced.
+ *
+ * When built with SPLITTER_VERIFY_CODECS, every fast path result is compared against lodepng::decode of the same input.
+ *
+ * @param out receives the raw pixels in the color mode of state.info_raw.
+ * @param w receives the width
+ * @param h receives the height
+ * @param state LodePNG state with the decoder settings. info_png is (re)filled from the file.
+ * @param in the encoded PNG
+ * @param insize size of in
+ * @return error code from lodePNG (0 = OK)
+ */
+// static
+unsigned FastPNGDecoder::decode(std::vector<unsigned char>& out, unsigned& w, unsigned& h, lodepng::State& state, const unsigned char* in, size_t insize) {
+    w = h = 0;
+    unsigned error = lodepng_inspect(&w, &h, &state, in, insize);
+    if (error) return error;
+
+    const bool fastPath = isRGBA8(state.info_png.color) && state.info_png.interlace_method == 0 &&
+                          (isRGBA8(state.info_raw) || !state.decoder.color_convert);
+    if (!fastPath) {
+        return lodepng::decode(out, w, h, state, in, insize);
+    }
+
+    error = decodeRGBA8(out, w, h, state, in, insize);
+
+#ifdef SPLITTER_VERIFY_CODECS
+    if (!error) {
+        lodepng::State referenceState;
+        lodepng_state_copy(&referenceState, &state);
+        std::vector<unsigned char> reference;
+        unsigned rw, rh;
+        unsigned referenceError = lodepng::decode(reference, rw, rh, referenceState, in, insize);
+        if (referenceError || rw != w || rh != h || reference != out) error = ERROR_CUSTOM_ZLIB;
+    }
+#endif
+
+    return error;
+}
+
+/**
+ * The fast path itself. lodepng_inspect already read the header into state.
+ * Mirrors the chunk handling of lodepng's decodeGeneric, minus the color types that cannot occur here.
+ */
+// static
+unsigned FastPNGDecoder::decodeRGBA8(std::vector<unsigned char>& out, unsigned w, unsigned h, lodepng::State& state, const unsigned char* in, size_t insize) {
+    const size_t rowBytes = static_cast<size_t>(w) * BYTES_PER_PIXEL;
+    if (h != 0 && rowBytes + 1 > SIZE_MAX / h) return ERROR_OVERFLOW;
+    const size_t expectedSize = (rowBytes + 1) * h;
+
+    // If all image data is in one IDAT (what lodepng and most encoders write), the zlib stream is used in place.
+    const unsigned char* idat = nullptr;
+    size_t idatSize = 0;
+    std::vector<unsigned char> idatConcatenated;
+
+    unsigned error = 0;
+    unsigned criticalPos = 1; // 1 = after IHDR, 2 = after PLTE, 3 = after IDAT
+    const unsigned char* chunk = in + 33; // lodepng_inspect verified signature + IHDR.
+    bool end = false;
+
+    while (!end && !error) {
+        if (static_cast<size_t>(chunk - in) + 12 > insize) {
+            if (state.decoder.ignore_end) break;
+            error = ERROR_CHUNK_PAST_END;
+            break;
+        }
+        const unsigned chunkLength = lodepng_chunk_length(chunk);
+        if (chunkLength > 2147483647u) {
+            if (state.decoder.ignore_end) break;
+            error = ERROR_CHUNK_LENGTH;
+            break;
+        }
+        if (static_cast<size_t>(chunk - in) + chunkLength + 12 > insize) {
+            error = ERROR_CHUNK_DATA_PAST_END;
+            break;
+        }
+
+        const unsigned char* data = lodepng_chunk_data_const(chunk);
+        bool known = true;
+
+        if (lodepng_chunk_type_equals(chunk, "IDAT")) {
+            if (idat == nullptr) {
+                idat = data;
+                idatSize = chunkLength;
+            } else {
+                if (idatConcatenated.empty()) idatConcatenated.assign(idat, idat + idatSize);
+                idatConcatenated.insert(idatConcatenated.end(), data, data + chunkLength);
+                idat = idatConcatenated.data();
+                idatSize = idatConcatenated.size();
+            }
+            criticalPos = 3;
+        } else if (lodepng_chunk_type_equals(chunk, "IEND")) {
+            end = true;
+        } else if (lodepng_chunk_type_equals(chunk, "PLTE")) {
+            // a suggested palette for a truecolor image. Kept, like lodepng does.
+            error = lodepng_inspect_chunk(&state, chunk - in, in, insize);
+            criticalPos = 2;
+        } else if (lodepng_chunk_type_equals(chunk, "tEXt") || lodepng_chunk_type_equals(chunk, "zTXt") || lodepng_chunk_type_equals(chunk, "iTXt")) {
+            if (state.decoder.read_text_chunks) error = lodepng_inspect_chunk(&state, chunk - in, in, insize);
+        } else if (lodepng_chunk_type_equals(chunk, "tRNS") || lodepng_chunk_type_equals(chunk, "bKGD") ||
+                   lodepng_chunk_type_equals(chunk, "tIME") || lodepng_chunk_type_equals(chunk, "pHYs") ||
+                   lodepng_chunk_type_equals(chunk, "gAMA") || lodepng_chunk_type_equals(chunk, "cHRM") ||
+                   lodepng_chunk_type_equals(chunk, "sRGB") || lodepng_chunk_type_equals(chunk, "iCCP")) {
+            error = lodepng_inspect_chunk(&state, chunk - in, in, insize);
+        } else {
+            known = false;
+            if (!state.decoder.ignore_critical && !lodepng_chunk_ancillary(chunk)) {
+                error = ERROR_UNKNOWN_CRITICAL;
+                break;
+            }
+            if (state.decoder.remember_unknown_chunks) {
+                error = lodepng_chunk_append(&state.info_png.unknown_chunks_data[criticalPos - 1],
+                                             &state.info_png.unknown_chunks_size[criticalPos - 1], chunk);
+            }
+        }
+
+        // lodepng_inspect_chunk checks the CRC of what it reads itself, doing it again costs next to nothing for these tiny chunks.
+        if (!error && known && !state.decoder.ignore_crc && lodepng_chunk_check_crc(chunk)) {
+            error = ERROR_CRC;
+        }
+
+        if (!end) chunk = lodepng_chunk_next_const(chunk, in + insize);
+    }
+    if (error) return error;
+
+    unsigned char* scanlines = nullptr;
+    size_t scanlinesSize = 0;
+    // the scanline size is known up front: an inflater that takes the hint can allocate its output once.
+    LodePNGDecompressSettings zlibSettings = state.decoder.zlibsettings;
+    const FastInflate::SizeHint sizeHint{expectedSize};
+    if (zlibSettings.custom_inflate == FastInflate::inflate) zlibSettings.custom_context = &sizeHint;
+    if (zlibSettings.custom_zlib) {
+        error = zlibSettings.custom_zlib(&scanlines, &scanlinesSize, idat, idatSize, &zlibSettings) ? ERROR_CUSTOM_ZLIB : 0;
+    } else {
+        error = lodepng_zlib_decompress(&scanlines, &scanlinesSize, idat, idatSize, &zlibSettings);
+    }
+    if (!error && scanlinesSize != expectedSize) error = ERROR_SIZE_MISMATCH;
+
+    if (!error) {
+        out.resize(rowBytes * h);
+        error = unfilterRGBA8(out.data(), scanlines, w, h);
+    }
+    std::free(scanlines);
+
+    if (!error && !state.decoder.color_convert) {
+        error = lodepng_color_mode_copy(&state.info_raw, &state.info_png.color);
+    }
+    return error;
+}
+
+/**
+ * Reverse the per-scanline filters (PNG specification, 9.2) of 8-bit RGBA data into tightly packed rows.
+ * @param out w * h * 4 bytes
+ * @param scanlines h * (1 + w * 4) bytes: each row starts with its filter type.
+ * @return 0, or 36 for an unknown filter type.
+ */
+// static
+unsigned FastPNGDecoder::unfilterRGBA8(unsigned char* out, const unsigned char* scanlines, unsigned w, unsigned h) {
+    const size_t rowBytes = static_cast<size_t>(w) * BYTES_PER_PIXEL;
+    // the row "above" the first one is all zeroes.
+    const std::vector<unsigned char> zeroRow(rowBytes, 0);
+    const unsigned char* precon = zeroRow.data();
+
+    for (unsigned y = 0; y < h; ++y) {
+        const unsigned char* scanline = scanlines + y * (rowBytes + 1);
+        unsigned char* recon = out + y * rowBytes;
+        const unsigned char filterType = scanline[0];
+        ++scanline;
+
+        switch (filterType) {
+            case 0:
+                std::memcpy(recon, scanline, rowBytes);
+                break;
+            case 1:
+                unfilterSub(recon, scanline, rowBytes);
+                break;
+            case 2:
+                unfilterUp(recon, scanline, precon, rowBytes);
+                break;
+            case 3:
+                unfilterAverage(recon, scanline, precon, rowBytes);
+                break;
+            case 4:
+                unfilterPaeth(recon, scanline, precon, rowBytes);
+                break;
+            default:
+                return ERROR_UNFILTER_TYPE;
+        }
+        precon = recon;
+    }
+    return 0;
+}
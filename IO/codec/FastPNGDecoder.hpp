@@ -0,0 +1,26 @@
+#ifndef SPRITESHEETSPLITTER_FASTPNGDECODER_HPP
+#define SPRITESHEETSPLITTER_FASTPNGDECODER_HPP
+
+#include <vector>
+#include "lodepng.h"
+
+/**
+ * PNG decoding with a fast path for what sprite sheets almost always are: 8-bit RGBA, not interlaced, decoded to 8-bit RGBA.
+ *
+ * On the fast path the IDAT data is not copied when it sits in a single chunk,
+ * the scanlines are unfiltered with SSE2 straight into the output, and no color conversion pass happens at all.
+ * Chunks are read like lodepng::decode does, so the State ends up the same (info_png, remembered unknown chunks).
+ *
+ * Every other PNG goes through lodepng::decode.
+ */
+class FastPNGDecoder {
+public:
+    // Same contract as lodepng::decode(out, w, h, state, in, insize).
+    static unsigned decode(std::vector<unsigned char>& out, unsigned& w, unsigned& h, lodepng::State& state, const unsigned char* in, size_t insize);
+
+private:
+    static unsigned decodeRGBA8(std::vector<unsigned char>& out, unsigned w, unsigned h, lodepng::State& state, const unsigned char* in, size_t insize);
+    static unsigned unfilterRGBA8(unsigned char* out, const unsigned char* scanlines, unsigned w, unsigned h);
+};
+
+#endif //SPRITESHEETSPLITTER_FASTPNGDECODER_HPP
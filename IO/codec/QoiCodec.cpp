@@ -0,0 +1,203 @@
+#include "QoiCodec.hpp"
+
+#include <cstring>
+
+namespace {
+
+// op codes. The first four are 2-bit tags in the high bits of the byte, the last two are full bytes.
+constexpr unsigned char OP_INDEX = 0x00;
+constexpr unsigned char OP_DIFF = 0x40;
+constexpr unsigned char OP_LUMA = 0x80;
+constexpr unsigned char OP_RUN = 0xc0;
+constexpr unsigned char OP_RGB = 0xfe;
+constexpr unsigned char OP_RGBA = 0xff;
+constexpr unsigned char TAG_MASK = 0xc0;
+
+constexpr unsigned char MAGIC[4] = {'q', 'o', 'i', 'f'};
+constexpr unsigned char END_MARKER[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+constexpr unsigned char COLORSPACE_SRGB = 0; // sRGB with linear alpha.
+
+// the spec limits images to 400 million pixels, to keep a decoder's output in bounds.
+constexpr size_t MAX_PIXELS = 400000000;
+
+// A pixel as r, g, b, a from the low byte up, whatever the byte order of the host.
+uint32_t loadPixel(const unsigned char* p) {
+    return p[0] | (p[1] << 8u) | (p[2] << 16u) | (static_cast<uint32_t>(p[3]) << 24u);
+}
+
+void storePixel(unsigned char* p, uint32_t px) {
+    p[0] = px & 255u;
+    p[1] = (px >> 8u) & 255u;
+    p[2] = (px >> 16u) & 255u;
+    p[3] = px >> 24u;
+}
+
+uint32_t channel(uint32_t px, unsigned c) {
+    return (px >> (8u * c)) & 255u;
+}
+
+void put32(unsigned char* p, uint32_t v) {
+    p[0] = v >> 24u;
+    p[1] = (v >> 16u) & 255u;
+    p[2] = (v >> 8u) & 255u;
+    p[3] = v & 255u;
+}
+
+uint32_t get32(const unsigned char* p) {
+    return (static_cast<uint32_t>(p[0]) << 24u) | (p[1] << 16u) | (p[2] << 8u) | p[3];
+}
+
+} // namespace
+
+/**
+ * Encode an 8-bit RGBA image as QOI. The output is sized for the worst case (every pixel a full OP_RGBA) up front,
+ * and trimmed to the written size at the end, so the loop itself never checks or grows the buffer.
+ *
+ * When built with SPLITTER_VERIFY_CODECS, the result is decoded again and compared to the image.
+ */
+// static
+unsigned QoiCodec::encode(std::vector<unsigned char>& out, const unsigned char* rgba, unsigned w, unsigned h) {
+    const size_t pixels = static_cast<size_t>(w) * h;
+    out.resize(HEADER_SIZE + pixels * 5 + END_MARKER_SIZE);
+    unsigned char* o = out.data();
+
+    std::memcpy(o, MAGIC, 4);
+    put32(o + 4, w);
+    put32(o + 8, h);
+    o[13] = COLORSPACE_SRGB;
+    o += HEADER_SIZE;
+
+    uint32_t index[64] = {};
+    uint32_t previous = 0xff000000u; // opaque black
+    unsigned run = 0;
+    bool opaque = true;
+
+    for (size_t i = 0; i < pixels; ++i) {
+        const uint32_t px = loadPixel(rgba + i * 4);
+        opaque &= channel(px, 3) == 255;
+        if (px == previous) {
+            if (++run == MAX_RUN) {
+                *o++ = OP_RUN | (run - 1);
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            *o++ = OP_RUN | (run - 1);
+            run = 0;
+        }
+
+        const unsigned slot = hash(px);
+        if (index[slot] == px) {
+            *o++ = OP_INDEX | slot;
+        } else {
+            index[slot] = px;
+            if (channel(px, 3) == channel(previous, 3)) {
+                // differences wrap around, as the spec says: 0 - 255 is +1.
+                const auto dr = static_cast<signed char>(channel(px, 0) - channel(previous, 0));
+                const auto dg = static_cast<signed char>(channel(px, 1) - channel(previous, 1));
+                const auto db = static_cast<signed char>(channel(px, 2) - channel(previous, 2));
+                const int drg = dr - dg;
+                const int dbg = db - dg;
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    *o++ = OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2);
+                } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                    *o++ = OP_LUMA | (dg + 32);
+                    *o++ = ((drg + 8) << 4) | (dbg + 8);
+                } else {
+                    *o++ = OP_RGB;
+                    *o++ = channel(px, 0);
+                    *o++ = channel(px, 1);
+                    *o++ = channel(px, 2);
+                }
+            } else {
+                *o++ = OP_RGBA;
+                storePixel(o, px);
+                o += 4;
+            }
+        }
+        previous = px;
+    }
+    if (run > 0) *o++ = OP_RUN | (run - 1);
+
+    std::memcpy(o, END_MARKER, END_MARKER_SIZE);
+    o += END_MARKER_SIZE;
+    out.resize(o - out.data());
+    out[12] = opaque ? 3 : 4;
+
+#ifdef SPLITTER_VERIFY_CODECS
+    std::vector<unsigned char> decoded;
+    unsigned dw, dh;
+    if (!decode(decoded, dw, dh, out.data(), out.size()) || dw != w || dh != h || std::memcmp(decoded.data(), rgba, pixels * 4) != 0) return 1;
+#endif
+    return 0;
+}
+
+/**
+ * Decode a QOI image to 8-bit RGBA. Reads are bounds checked: truncated or corrupt data fails instead of reading past the input.
+ * Pixels of a run that the data ends in the middle of, or that are left without data, count as corrupt.
+ */
+// static
+bool QoiCodec::decode(std::vector<unsigned char>& out, unsigned& w, unsigned& h, const unsigned char* in, size_t size) {
+    if (size < HEADER_SIZE + END_MARKER_SIZE || std::memcmp(in, MAGIC, 4) != 0) return false;
+    w = get32(in + 4);
+    h = get32(in + 8);
+    const unsigned channels = in[12];
+    const size_t pixels = static_cast<size_t>(w) * h;
+    if (w == 0 || h == 0 || pixels > MAX_PIXELS || (channels != 3 && channels != 4) || in[13] > 1) return false;
+
+    out.resize(pixels * 4);
+    uint32_t index[64] = {};
+    uint32_t px = 0xff000000u;
+    const unsigned char* p = in + HEADER_SIZE;
+    const unsigned char* end = in + size - END_MARKER_SIZE;
+
+    size_t i = 0;
+    while (i < pixels) {
+        if (p >= end) return false;
+        const unsigned char op = *p++;
+        if (op == OP_RGB) {
+            if (end - p < 3) return false;
+            px = (px & 0xff000000u) | p[0] | (p[1] << 8u) | (p[2] << 16u);
+            p += 3;
+        } else if (op == OP_RGBA) {
+            if (end - p < 4) return false;
+            px = loadPixel(p);
+            p += 4;
+        } else if ((op & TAG_MASK) == OP_INDEX) {
+            px = index[op];
+        } else if ((op & TAG_MASK) == OP_DIFF) {
+            const uint32_t r = channel(px, 0) + ((op >> 4u) & 3u) - 2;
+            const uint32_t g = channel(px, 1) + ((op >> 2u) & 3u) - 2;
+            const uint32_t b = channel(px, 2) + (op & 3u) - 2;
+            px = (px & 0xff000000u) | (r & 255u) | ((g & 255u) << 8u) | ((b & 255u) << 16u);
+        } else if ((op & TAG_MASK) == OP_LUMA) {
+            if (p >= end) return false;
+            const int dg = (op & 0x3f) - 32;
+            const int drg = (*p >> 4u) - 8;
+            const int dbg = (*p & 15u) - 8;
+            ++p;
+            const uint32_t r = channel(px, 0) + dg + drg;
+            const uint32_t g = channel(px, 1) + dg;
+            const uint32_t b = channel(px, 2) + dg + dbg;
+            px = (px & 0xff000000u) | (r & 255u) | ((g & 255u) << 8u) | ((b & 255u) << 16u);
+        } else { // OP_RUN
+            const size_t run = (op & 0x3f) + 1;
+            if (run > pixels - i) return false;
+            for (size_t r = 0; r < run; ++r) storePixel(out.data() + (i + r) * 4, px);
+            i += run;
+            index[hash(px)] = px;
+            continue;
+        }
+        index[hash(px)] = px;
+        storePixel(out.data() + i * 4, px);
+        ++i;
+    }
+
+    return std::memcmp(p, END_MARKER, END_MARKER_SIZE) == 0;
+}
+
+// static
+unsigned QoiCodec::hash(uint32_t rgba) {
+    return (channel(rgba, 0) * 3 + channel(rgba, 1) * 5 + channel(rgba, 2) * 7 + channel(rgba, 3) * 11) % 64;
+}
@@ -0,0 +1,32 @@
+#ifndef SPRITESHEETSPLITTER_QOICODEC_HPP
+#define SPRITESHEETSPLITTER_QOICODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Encoder and decoder for the QOI image format (qoiformat.org, specification 1.0), for 8-bit RGBA sprites.
+ *
+ * QOI is lossless like PNG, but has no filtering or entropy coding: every pixel is written as a run, a reference into
+ * a 64 entry table of recently seen colors, a small difference to the previous pixel, or the plain color.
+ * That is one linear pass with a few hundred bytes of state, where PNG spends most of its encode time in deflate.
+ * Files are larger than PNG, and there is no place for ancillary data such as text chunks.
+ */
+class QoiCodec {
+public:
+    // Encode an RGBA image. The file says 3 channels if every pixel is opaque, 4 otherwise.
+    // Returns 0, or 1 if built with SPLITTER_VERIFY_CODECS and decoding the result does not give the image back.
+    static unsigned encode(std::vector<unsigned char>& out, const unsigned char* rgba, unsigned w, unsigned h);
+    // Decode to RGBA, whatever the channel count in the header. Returns false if the data is not a valid QOI image.
+    static bool decode(std::vector<unsigned char>& out, unsigned& w, unsigned& h, const unsigned char* in, size_t size);
+
+private:
+    static constexpr size_t HEADER_SIZE = 14;
+    static constexpr size_t END_MARKER_SIZE = 8;
+    static constexpr unsigned MAX_RUN = 62;
+
+    static unsigned hash(uint32_t rgba);
+};
+
+#endif //SPRITESHEETSPLITTER_QOICODEC_HPP
@@ -0,0 +1,195 @@
+#include "SheetChunks.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <string>
+
+namespace {
+
+// A chunk is its data plus 12 bytes: length, type and CRC.
+constexpr size_t CHUNK_OVERHEAD = 12;
+// How often the time to serialize the chunks is measured.
+constexpr unsigned TIMING_ROUNDS = 3;
+
+std::string chunkType(const unsigned char* chunk) {
+    char type[5];
+    lodepng_chunk_type(type, chunk);
+    return type;
+}
+
+// Chunks that describe the pixels of the sprite itself, rather than the sheet. These are written by the encoder.
+bool isImageChunk(const std::string& type) {
+    return type == "IHDR" || type == "PLTE" || type == "tRNS" || type == "bKGD" || type == "IDAT" || type == "IEND";
+}
+
+// With text_compression, lodepng writes the texts of a sheet as zTXt whatever they were: tEXt and zTXt count as one type.
+bool policyKeeps(const ChunkPolicy& policy, const std::string& type) {
+    if (type == "tEXt" || type == "zTXt") return policy.keeps("tEXt") || policy.keeps("zTXt");
+    return policy.keeps(type);
+}
+
+size_t backgroundChunkSize(const LodePNGColorMode& color) {
+    switch (color.colortype) {
+        case LCT_PALETTE:
+            return 1 + CHUNK_OVERHEAD;
+        case LCT_GREY:
+        case LCT_GREY_ALPHA:
+            return 2 + CHUNK_OVERHEAD;
+        default:
+            return 6 + CHUNK_OVERHEAD;
+    }
+}
+
+} // namespace
+
+/**
+ * Serialize the chunks of state.info_png once, keep what the policy allows, and leave them in state.info_png
+ * as unknown chunks. The positions lodepng writes them at are kept:
+ * - iCCP, sRGB, gAMA, cHRM: after the unknown chunks before PLTE.
+ * - pHYs: before the unknown chunks between PLTE and IDAT.
+ * - tIME and text: before the unknown chunks after IDAT.
+ *
+ * @param state LodePNG State of the sheet, about to encode its sprites.
+ * @param pixel one RGBA pixel of the sheet, used to encode the image that carries the chunks.
+ * @param policy which chunk types to keep.
+ * @param savings receives what this saves per sprite.
+ * @return error code from lodePNG (0 = OK). On error, state is unchanged.
+ */
+// static
+unsigned SheetChunks::prepare(lodepng::State& state, const unsigned char* pixel, const ChunkPolicy& policy, Savings& savings) {
+    LodePNGInfo& info = state.info_png;
+    savings.droppedBytes = 0;
+    savings.serializeSeconds = 0;
+
+    // what serializing the chunks costs a sprite: the encode with them, less the same encode without them. Both are warm,
+    // as the first encode of a thread spends most of its time setting up, and the fastest of a few: the difference is small.
+    lodepng::State bare(state);
+    clearKnownChunks(bare.info_png);
+    std::vector<unsigned char> png;
+    std::vector<unsigned char> barePng;
+    unsigned error = serializeKnownChunks(barePng, bare, pixel);
+    double chunkSeconds = std::numeric_limits<double>::max();
+    double bareSeconds = std::numeric_limits<double>::max();
+    for (unsigned round = 0; !error && round < TIMING_ROUNDS; ++round) {
+        png.clear();
+        barePng.clear();
+        const auto start = std::chrono::steady_clock::now();
+        error = serializeKnownChunks(png, state, pixel);
+        const auto serialized = std::chrono::steady_clock::now();
+        if (!error) error = serializeKnownChunks(barePng, bare, pixel);
+        const auto end = std::chrono::steady_clock::now();
+        chunkSeconds = std::min(chunkSeconds, std::chrono::duration<double>(serialized - start).count());
+        bareSeconds = std::min(bareSeconds, std::chrono::duration<double>(end - serialized).count());
+    }
+    if (error) return error;
+
+    // the known chunks, in the position they go to.
+    std::vector<const unsigned char*> known[3];
+    bool afterIDAT = false;
+    const unsigned char* end = png.data() + png.size();
+    for (const unsigned char* chunk = png.data() + 8; chunk + CHUNK_OVERHEAD <= end; chunk = lodepng_chunk_next_const(chunk, end)) {
+        const std::string type = chunkType(chunk);
+        if (type == "IDAT") afterIDAT = true;
+        if (isImageChunk(type)) continue;
+        known[afterIDAT ? 2 : type == "pHYs" ? 1 : 0].push_back(chunk);
+    }
+
+    unsigned char* data[3] = {nullptr, nullptr, nullptr};
+    size_t size[3] = {0, 0, 0};
+    auto keep = [&](unsigned position, const unsigned char* chunk) {
+        if (policyKeeps(policy, chunkType(chunk))) {
+            if (!error) error = lodepng_chunk_append(&data[position], &size[position], chunk);
+            return true;
+        }
+        savings.droppedBytes += lodepng_chunk_length(chunk) + CHUNK_OVERHEAD;
+        return false;
+    };
+    auto keepUnknown = [&](unsigned position) {
+        const unsigned char* unknown = info.unknown_chunks_data[position];
+        const unsigned char* unknownEnd = unknown + info.unknown_chunks_size[position];
+        for (const unsigned char* chunk = unknown; chunk && chunk + CHUNK_OVERHEAD <= unknownEnd; chunk = lodepng_chunk_next_const(chunk, unknownEnd)) {
+            keep(position, chunk);
+        }
+    };
+    bool keptKnown = false; // only known chunks were serialized per sprite before: unknown ones were copied as they are.
+    auto keepKnown = [&](unsigned position) {
+        for (const unsigned char* chunk : known[position]) keptKnown |= keep(position, chunk);
+    };
+
+    keepUnknown(0);
+    keepKnown(0);
+    keepKnown(1);
+    keepUnknown(1);
+    keepKnown(2);
+    keepUnknown(2);
+
+    if (error) {
+        for (auto* d : data) std::free(d);
+        return error;
+    }
+
+    for (unsigned i = 0; i < 3; ++i) {
+        std::free(info.unknown_chunks_data[i]);
+        info.unknown_chunks_data[i] = data[i];
+        info.unknown_chunks_size[i] = size[i];
+    }
+    clearKnownChunks(info);
+    if (info.background_defined && !policy.keeps("bKGD")) {
+        info.background_defined = 0;
+        savings.droppedBytes += backgroundChunkSize(info.color);
+    }
+    if (keptKnown) savings.serializeSeconds = std::max(chunkSeconds - bareSeconds, 0.0);
+
+    return 0;
+}
+
+/**
+ * Encode a 1x1 image with the known chunks of state.info_png, and without its unknown chunks or bKGD.
+ * state is restored afterwards.
+ */
+// static
+unsigned SheetChunks::serializeKnownChunks(std::vector<unsigned char>& png, lodepng::State& state, const unsigned char* pixel) {
+    LodePNGInfo& info = state.info_png;
+    unsigned char* unknownData[3];
+    size_t unknownSize[3];
+    for (unsigned i = 0; i < 3; ++i) {
+        unknownData[i] = info.unknown_chunks_data[i];
+        unknownSize[i] = info.unknown_chunks_size[i];
+        info.unknown_chunks_data[i] = nullptr;
+        info.unknown_chunks_size[i] = 0;
+    }
+    const unsigned background = info.background_defined;
+    info.background_defined = 0;
+
+    const unsigned error = lodepng::encode(png, pixel, 1, 1, state);
+
+    info.background_defined = background;
+    for (unsigned i = 0; i < 3; ++i) {
+        info.unknown_chunks_data[i] = unknownData[i];
+        info.unknown_chunks_size[i] = unknownSize[i];
+    }
+    return error;
+}
+
+// static
+void SheetChunks::clearKnownChunks(LodePNGInfo& info) {
+    // lodepng_clear_text and lodepng_clear_itext free the texts, but leave the dangling pointers and counts in place.
+    lodepng_clear_text(&info);
+    info.text_num = 0;
+    info.text_keys = nullptr;
+    info.text_strings = nullptr;
+    lodepng_clear_itext(&info);
+    info.itext_num = 0;
+    info.itext_keys = nullptr;
+    info.itext_langtags = nullptr;
+    info.itext_transkeys = nullptr;
+    info.itext_strings = nullptr;
+    lodepng_clear_icc(&info);
+    info.gama_defined = 0;
+    info.chrm_defined = 0;
+    info.srgb_defined = 0;
+    info.phys_defined = 0;
+    info.time_defined = 0;
+}
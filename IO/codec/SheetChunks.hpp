@@ -0,0 +1,33 @@
+#ifndef SPRITESHEETSPLITTER_SHEETCHUNKS_HPP
+#define SPRITESHEETSPLITTER_SHEETCHUNKS_HPP
+
+#include <vector>
+#include "lodepng.h"
+#include "../../util/ChunkPolicy.h"
+
+/**
+ * Prepares the ancillary chunks of a sheet once, before its sprites are encoded.
+ *
+ * lodepng keeps the chunks it knows (text, iCCP, gAMA, pHYs, tIME..) parsed in LodePNGInfo, and serializes them again
+ * for every encoded image: CRCs are recomputed, and zTXt and iCCP are deflated again, for every single sprite.
+ * Here they are serialized once, filtered by a ChunkPolicy, and handed to lodepng as unknown chunks,
+ * which it copies into each sprite verbatim. With every chunk kept, the sprites are byte-identical to before.
+ *
+ * bKGD stays parsed: it is converted along when a sprite is written in another color type (see SpriteEncoder).
+ */
+class SheetChunks {
+public:
+    struct Savings {
+        size_t droppedBytes; // per sprite: the size of the chunks the policy left out.
+        double serializeSeconds; // the time serializing the kept chunks takes a sprite, which now happens once. 0 if none are kept.
+    };
+
+    // Rewrite the chunks of state.info_png as described above. pixel is one RGBA pixel of the sheet.
+    static unsigned prepare(lodepng::State& state, const unsigned char* pixel, const ChunkPolicy& policy, Savings& savings);
+
+private:
+    static unsigned serializeKnownChunks(std::vector<unsigned char>& png, lodepng::State& state, const unsigned char* pixel);
+    static void clearKnownChunks(LodePNGInfo& info);
+};
+
+#endif //SPRITESHEETSPLITTER_SHEETCHUNKS_HPP
@@ -0,0 +1,354 @@
+#include "SpriteEncoder.hpp"
+
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Below this many pixels (16x16), filtering never paid off by more than 2% on the measured sprites.
+constexpr size_t SMALL_SPRITE_PIXELS = 16 * 16;
+// Up to this many colors a 4-bit palette beats 8-bit gray, despite its PLTE chunk.
+constexpr unsigned SMALL_PALETTE = 16;
+// With fewer pixels per color, PLTE and tRNS outweigh the smaller pixels: on the measured sprites, a palette was
+// 10-35% larger than RGB(A) below 6 pixels per color, and 10-35% smaller from 8 up. (lodepng's own rule is 2)
+constexpr size_t PALETTE_PIXELS_PER_COLOR = 8;
+
+// Pixels are handled as one 32-bit word: R in the lowest byte, A in the highest (little endian, like the rest of the codecs).
+inline uint32_t loadPixel(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline unsigned red(uint32_t pixel) { return pixel & 255u; }
+inline unsigned green(uint32_t pixel) { return (pixel >> 8u) & 255u; }
+inline unsigned blue(uint32_t pixel) { return (pixel >> 16u) & 255u; }
+inline unsigned alpha(uint32_t pixel) { return pixel >> 24u; }
+
+bool isRGBA8(const LodePNGColorMode& mode) {
+    return mode.colortype == LCT_RGBA && mode.bitdepth == 8;
+}
+
+// Unknown chunks are written back unchanged, whatever the color type of the sprite. (see also SheetChunks)
+bool hasUnknownChunk(const LodePNGInfo& info, const char* type) {
+    for (unsigned i = 0; i < 3; ++i) {
+        const unsigned char* data = info.unknown_chunks_data[i];
+        const unsigned char* end = data + info.unknown_chunks_size[i];
+        for (const unsigned char* chunk = data; chunk && chunk + 12 <= end; chunk = lodepng_chunk_next_const(chunk, end)) {
+            if (lodepng_chunk_type_equals(chunk, type)) return true;
+        }
+    }
+    return false;
+}
+
+LodePNGFilterStrategy filterStrategyFor(size_t pixels, bool fewColors) {
+    return pixels < SMALL_SPRITE_PIXELS || fewColors ? LFS_ZERO : LFS_MINSUM;
+}
+
+} // namespace
+
+/**
+ * Encode an 8-bit RGBA sprite. The filter strategy is chosen per profile:
+ * - FAST: filter 0 on every scanline, which costs nothing to choose.
+ * - DEFAULT: filter 0 for flat pixel art and small sprites, LFS_MINSUM otherwise.
+ * - MAX: encodes with both filter 0 and LFS_MINSUM, and keeps the smaller result.
+ *
+ * With reduceColors, the sprite is written in the smallest color type that holds it losslessly, see encodeReduced.
+ *
+ * @param out receives the PNG file.
+ * @param sprite w * h RGBA pixels.
+ * @param state LodePNG State to encode with. Its filter_strategy is overwritten.
+ * @return error code from lodePNG (0 = OK)
+ */
+// static
+unsigned SpriteEncoder::encode(std::vector<unsigned char>& out, const unsigned char* sprite, unsigned w, unsigned h,
+                               lodepng::State& state, CompressionProfile profile, bool reduceColors) {
+    // only RGBA output is reduced: a sheet in another color type keeps writing its sprites in that type.
+    // sBIT depends on the color type, so a sheet with one is not reduced either.
+    if (reduceColors && isRGBA8(state.info_png.color) && isRGBA8(state.info_raw) && !hasUnknownChunk(state.info_png, "sBIT")) {
+        const Frame frame {sprite, w, h};
+        return encodeReduced(&out, &frame, 1, sprite, static_cast<size_t>(w) * h, state, profile);
+    }
+
+    LodePNGFilterStrategy adaptive = LFS_ZERO;
+    const size_t pixels = static_cast<size_t>(w) * h;
+    if (profile == CompressionProfile::DEFAULT && pixels >= SMALL_SPRITE_PIXELS) {
+        uint32_t colors[FEW_COLORS];
+        adaptive = filterStrategyFor(pixels, countColors(sprite, pixels, colors) <= FEW_COLORS);
+    }
+    return encodeWithProfile(out, sprite, w, h, state, profile, adaptive);
+}
+
+/**
+ * Encode the frames of an animation like encode does for sprites, with the color type and filter strategy chosen once,
+ * over the pixels of all frames together: every frame is written in the same color type, with the same palette.
+ * The filter strategy depends on the size of the first frame.
+ *
+ * @param out receives one PNG file per frame.
+ * @return error code from lodePNG (0 = OK), of the first frame that failed.
+ */
+// static
+unsigned SpriteEncoder::encodeFrames(std::vector<std::vector<unsigned char>>& out, const std::vector<Frame>& frames,
+                                     lodepng::State& state, CompressionProfile profile, bool reduceColors) {
+    out.assign(frames.size(), {});
+    if (frames.empty()) return 0;
+
+    // one buffer to analyze, rather than teaching the analysis about frames.
+    std::vector<unsigned char> pixels;
+    for (const Frame& frame : frames) pixels.insert(pixels.end(), frame.rgba, frame.rgba + static_cast<size_t>(frame.w) * frame.h * 4);
+    const size_t pixelCount = pixels.size() / 4;
+
+    if (reduceColors && isRGBA8(state.info_png.color) && isRGBA8(state.info_raw) && !hasUnknownChunk(state.info_png, "sBIT")) {
+        return encodeReduced(out.data(), frames.data(), frames.size(), pixels.data(), pixelCount, state, profile);
+    }
+
+    LodePNGFilterStrategy adaptive = LFS_ZERO;
+    const size_t framePixels = static_cast<size_t>(frames[0].w) * frames[0].h;
+    if (profile == CompressionProfile::DEFAULT && framePixels >= SMALL_SPRITE_PIXELS) {
+        uint32_t colors[FEW_COLORS];
+        adaptive = filterStrategyFor(framePixels, countColors(pixels.data(), pixelCount, colors) <= FEW_COLORS);
+    }
+    unsigned error = 0;
+    for (size_t i = 0; !error && i < frames.size(); ++i) {
+        error = encodeWithProfile(out[i], frames[i].rgba, frames[i].w, frames[i].h, state, profile, adaptive);
+    }
+    return error;
+}
+
+/**
+ * @param adaptive the filter strategy the DEFAULT profile uses for this sprite.
+ */
+// static
+unsigned SpriteEncoder::encodeWithProfile(std::vector<unsigned char>& out, const unsigned char* sprite, unsigned w, unsigned h,
+                                          lodepng::State& state, CompressionProfile profile, LodePNGFilterStrategy adaptive) {
+    switch (profile) {
+        case CompressionProfile::FAST:
+            state.encoder.filter_strategy = LFS_ZERO;
+            break;
+        case CompressionProfile::DEFAULT:
+            state.encoder.filter_strategy = adaptive;
+            break;
+        case CompressionProfile::MAX: {
+            state.encoder.filter_strategy = LFS_ZERO;
+            unsigned error = lodepng::encode(out, sprite, w, h, state);
+            if (error) return error;
+
+            std::vector<unsigned char> alternative;
+            state.encoder.filter_strategy = LFS_MINSUM;
+            error = lodepng::encode(alternative, sprite, w, h, state);
+            if (!error && alternative.size() < out.size()) out.swap(alternative);
+            return error;
+        }
+    }
+    return lodepng::encode(out, sprite, w, h, state);
+}
+
+/**
+ * Encode in the smallest color type that decodes back to exactly the same RGBA pixels.
+ * The color mode (and bKGD color) of state.info_png are changed for these frames only, and restored afterwards.
+ *
+ * When built with SPLITTER_VERIFY_CODECS, the result is decoded again and compared to the sprite.
+ * A mismatch is reported as error 1.
+ *
+ * @param out receives a PNG file per frame: count of them.
+ * @param frames count sprites, encoded in the same color type. A single sprite is one frame.
+ * @param pixels the pixels the color type is chosen for: those of all frames.
+ */
+// static
+unsigned SpriteEncoder::encodeReduced(std::vector<unsigned char>* out, const Frame* frames, size_t count, const unsigned char* pixels, size_t pixelCount,
+                                      lodepng::State& state, CompressionProfile profile) {
+    LodePNGInfo& info = state.info_png;
+    ColorAnalysis analysis{};
+    analyzeColors(pixels, pixelCount, analysis);
+
+    // the bKGD color has to survive the reduction as well: it counts as one more opaque color.
+    if (info.background_defined) {
+        const uint32_t background = (info.background_r & 255u) | ((info.background_g & 255u) << 8u) | ((info.background_b & 255u) << 16u) | 0xFF000000u;
+        analysis.gray = analysis.gray && info.background_r == info.background_g && info.background_g == info.background_b;
+        bool known = false;
+        for (unsigned i = 0; !known && i < analysis.colorCount && i < FEW_COLORS; ++i) known = analysis.colors[i] == background;
+        if (!known && analysis.colorCount <= FEW_COLORS) {
+            if (analysis.colorCount < FEW_COLORS) analysis.colors[analysis.colorCount] = background;
+            analysis.colorCount++;
+        }
+    }
+    // PNG forbids gray color types with an RGB ICC profile. (RGBA sheets cannot carry a gray one)
+    if (info.iccp_defined || hasUnknownChunk(info, "iCCP")) analysis.gray = false;
+
+    LodePNGColorMode originalMode = lodepng_color_mode_make(LCT_RGBA, 8);
+    unsigned error = lodepng_color_mode_copy(&originalMode, &info.color);
+    const unsigned originalBackground = info.background_r;
+
+    if (!error) reduceColorMode(analysis, info);
+    const LodePNGFilterStrategy adaptive = filterStrategyFor(static_cast<size_t>(frames[0].w) * frames[0].h, analysis.colorCount <= FEW_COLORS);
+    for (size_t i = 0; !error && i < count; ++i) {
+        const Frame& frame = frames[i];
+        error = encodeWithProfile(out[i], frame.rgba, frame.w, frame.h, state, profile, adaptive);
+
+#ifdef SPLITTER_VERIFY_CODECS
+        if (!error) {
+            std::vector<unsigned char> decoded;
+            unsigned dw, dh;
+            const unsigned decodeError = lodepng::decode(decoded, dw, dh, out[i], LCT_RGBA, 8);
+            if (decodeError || dw != frame.w || dh != frame.h || std::memcmp(decoded.data(), frame.rgba, static_cast<size_t>(frame.w) * frame.h * 4) != 0) error = 1;
+        }
+#endif
+    }
+
+    lodepng_color_mode_copy(&info.color, &originalMode);
+    lodepng_color_mode_cleanup(&originalMode);
+    info.background_r = originalBackground;
+    return error;
+}
+
+/**
+ * Collect the distinct colors of a sprite, stopping at the first color over FEW_COLORS.
+ * Runs of the same pixel (typical for pixel art and transparent borders) are skipped without a lookup.
+ *
+ * @param colors receives the first FEW_COLORS distinct colors, in order of appearance.
+ * @return the number of distinct colors, or FEW_COLORS + 1 if there are more.
+ */
+// static
+unsigned SpriteEncoder::countColors(const unsigned char* sprite, size_t pixels, uint32_t* colors) {
+    // open addressing set of 32-bit colors, kept at most half full. Slot value 0 is free: transparent black is tracked separately.
+    constexpr unsigned SLOTS = FEW_COLORS * 2;
+    uint32_t slots[SLOTS] = {0};
+    unsigned count = 0;
+    bool seenZero = false;
+
+    uint32_t previous = pixels ? loadPixel(sprite) ^ 1u : 0; // anything but the first pixel
+    for (size_t i = 0; i < pixels; ++i) {
+        const uint32_t pixel = loadPixel(sprite + i * 4);
+        if (pixel == previous) continue;
+        previous = pixel;
+
+        bool added = false;
+        if (pixel == 0) {
+            added = !seenZero;
+            seenZero = true;
+        } else {
+            unsigned slot = (pixel * 2654435761u) >> 23u; // 9 bits: SLOTS = 512
+            while (slots[slot] != 0 && slots[slot] != pixel) slot = (slot + 1) & (SLOTS - 1);
+            if (slots[slot] == 0) {
+                slots[slot] = pixel;
+                added = true;
+            }
+        }
+        if (added) {
+            if (count == FEW_COLORS) return FEW_COLORS + 1;
+            colors[count++] = pixel;
+        }
+    }
+    return count;
+}
+
+/**
+ * Fill a ColorAnalysis for a sprite: the color set, and with SSE2 four pixels at a time, whether it is opaque and gray.
+ * Whether it can use a color key is only worked out when that matters: not opaque, and no palette.
+ */
+// static
+void SpriteEncoder::analyzeColors(const unsigned char* sprite, size_t pixels, ColorAnalysis& analysis) {
+    analysis.colorCount = countColors(sprite, pixels, analysis.colors);
+
+    // AND of all pixels: its alpha is 255 only if every alpha is. OR of (pixel ^ pixel >> 8): its low 16 bits are R^G and G^B.
+    uint32_t allBits = 0xFFFFFFFFu;
+    uint32_t channelDifferences = 0;
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128i allBits4 = _mm_set1_epi32(-1);
+    __m128i channelDifferences4 = _mm_setzero_si128();
+    for (; i + 4 <= pixels; i += 4) {
+        const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sprite + i * 4));
+        allBits4 = _mm_and_si128(allBits4, p);
+        channelDifferences4 = _mm_or_si128(channelDifferences4, _mm_xor_si128(p, _mm_srli_epi32(p, 8)));
+    }
+    uint32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), allBits4);
+    allBits = lanes[0] & lanes[1] & lanes[2] & lanes[3];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), channelDifferences4);
+    channelDifferences = lanes[0] | lanes[1] | lanes[2] | lanes[3];
+#endif
+    for (; i < pixels; ++i) {
+        const uint32_t pixel = loadPixel(sprite + i * 4);
+        allBits &= pixel;
+        channelDifferences |= pixel ^ (pixel >> 8u);
+    }
+    analysis.opaque = alpha(allBits) == 255;
+    analysis.gray = (channelDifferences & 0xFFFFu) == 0;
+
+    analysis.pixels = pixels;
+    analysis.keyed = false;
+    analysis.key = 0;
+    if (analysis.opaque || paletteFits(analysis.colorCount, pixels)) return;
+
+    size_t first = 0;
+    while (alpha(loadPixel(sprite + first * 4)) == 255) ++first; // exists: not opaque.
+    const uint32_t key = loadPixel(sprite + first * 4);
+    if (alpha(key) != 0) return;
+
+    for (size_t j = 0; j < pixels; ++j) {
+        const uint32_t pixel = loadPixel(sprite + j * 4);
+        const bool conflicts = alpha(pixel) == 255 ? (pixel & 0x00FFFFFFu) == (key & 0x00FFFFFFu) : pixel != key;
+        if (conflicts) return; // an opaque pixel that would turn transparent, or a transparent pixel that is not the key.
+    }
+    analysis.keyed = true;
+    analysis.key = key;
+}
+
+// Whether a palette holds the colors, and pays for its PLTE and tRNS chunks.
+// static
+bool SpriteEncoder::paletteFits(unsigned colorCount, size_t pixels) {
+    return colorCount <= FEW_COLORS && pixels >= colorCount * PALETTE_PIXELS_PER_COLOR;
+}
+
+/**
+ * Set info.color to the smallest color type that holds every color of the analysis.
+ * Expects info.color to be 8-bit RGBA, which stays in place if nothing smaller fits. A bKGD color is converted along.
+ */
+// static
+void SpriteEncoder::reduceColorMode(const ColorAnalysis& analysis, LodePNGInfo& info) {
+    LodePNGColorMode& mode = info.color;
+    if (analysis.gray && analysis.opaque && analysis.colorCount > SMALL_PALETTE) {
+        mode.colortype = LCT_GREY;
+        mode.bitdepth = 8;
+    } else if (paletteFits(analysis.colorCount, analysis.pixels)) {
+        mode.colortype = LCT_PALETTE;
+        const unsigned count = analysis.colorCount;
+        mode.bitdepth = count <= 2 ? 1 : count <= 4 ? 2 : count <= 16 ? 4 : 8;
+        lodepng_palette_clear(&mode);
+        // translucent entries first: tRNS only needs to go up to the last one of them.
+        for (unsigned pass = 0; pass < 2; ++pass) {
+            for (unsigned i = 0; i < count; ++i) {
+                const uint32_t color = analysis.colors[i];
+                if ((alpha(color) == 255) != (pass == 1)) continue;
+                lodepng_palette_add(&mode, red(color), green(color), blue(color), alpha(color));
+            }
+        }
+        if (info.background_defined) {
+            const uint32_t background = (info.background_r & 255u) | ((info.background_g & 255u) << 8u) | ((info.background_b & 255u) << 16u);
+            for (unsigned i = 0; i < mode.palettesize; ++i) {
+                const unsigned char* entry = &mode.palette[i * 4];
+                if (entry[3] == 255 && static_cast<uint32_t>(entry[0] | (entry[1] << 8u) | (entry[2] << 16u)) == background) {
+                    info.background_r = i;
+                    break;
+                }
+            }
+        }
+    } else if (analysis.opaque) {
+        // gray with few colors gets here too, when there are too few pixels for a palette to pay.
+        mode.colortype = analysis.gray ? LCT_GREY : LCT_RGB;
+        mode.bitdepth = 8;
+    } else if (analysis.keyed) {
+        mode.colortype = analysis.gray ? LCT_GREY : LCT_RGB;
+        mode.bitdepth = 8;
+        mode.key_defined = 1;
+        mode.key_r = red(analysis.key);
+        mode.key_g = green(analysis.key);
+        mode.key_b = blue(analysis.key);
+    } else if (analysis.gray) {
+        mode.colortype = LCT_GREY_ALPHA;
+        mode.bitdepth = 8;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef SPRITESHEETSPLITTER_SPRITEENCODER_HPP
+#define SPRITESHEETSPLITTER_SPRITEENCODER_HPP
+
+#include <cstdint>
+#include <vector>
+#include "lodepng.h"
+#include "../../util/CompressionProfile.h"
+
+/**
+ * Encodes single sprites (8-bit RGBA) to PNG, picking the scanline filter strategy per sprite.
+ *
+ * lodepng's default, LFS_MINSUM, tries all five filters on every scanline. For pixel art and for sprites of a few rows,
+ * filter 0 on every line compresses better and costs nothing to pick. Measured on split sprites:
+ * - Flat pixel art (at most 256 colors) is 30-45% smaller with filter 0 than with LFS_MINSUM, at every sprite size.
+ * - Shaded sprites below 16x16 are within 2% either way. From 16x16 up, LFS_MINSUM is 1-25% smaller.
+ * - LFS_BRUTE_FORCE was never the smallest, at 10-30x the encode time.
+ *
+ * Optionally, sprites are written in the smallest color type that decodes back to exactly the same RGBA pixels:
+ * palette, gray, gray+alpha, RGB, or gray/RGB with a transparent color key.
+ */
+class SpriteEncoder {
+public:
+    // One frame of an animation: w * h RGBA pixels.
+    struct Frame {
+        const unsigned char* rgba;
+        unsigned w;
+        unsigned h;
+    };
+
+    // Like lodepng::encode(out, sprite, w, h, state), with the filter strategy (and color type) of state chosen per sprite.
+    static unsigned encode(std::vector<unsigned char>& out, const unsigned char* sprite, unsigned w, unsigned h,
+                           lodepng::State& state, CompressionProfile profile, bool reduceColors);
+    // Like encode for every frame, with one color type (and palette) for all of them. See ApngEncoder.
+    static unsigned encodeFrames(std::vector<std::vector<unsigned char>>& out, const std::vector<Frame>& frames,
+                                 lodepng::State& state, CompressionProfile profile, bool reduceColors);
+
+private:
+    static constexpr unsigned FEW_COLORS = 256; // what a palette can hold.
+
+    // What one pass over a sprite tells about the color types that can represent it losslessly.
+    struct ColorAnalysis {
+        uint32_t colors[FEW_COLORS]; // the distinct colors, as loaded from memory, in order of appearance. Only complete if colorCount <= FEW_COLORS.
+        unsigned colorCount; // at most FEW_COLORS + 1: counting stops there.
+        size_t pixels;
+        bool opaque; // every alpha is 255
+        bool gray; // r == g == b for every pixel
+        bool keyed; // every pixel that is not opaque is the same fully transparent color, and no opaque pixel has its RGB.
+        uint32_t key; // that color, if keyed.
+    };
+
+    static unsigned encodeWithProfile(std::vector<unsigned char>& out, const unsigned char* sprite, unsigned w, unsigned h,
+                                      lodepng::State& state, CompressionProfile profile, LodePNGFilterStrategy adaptive);
+    static unsigned encodeReduced(std::vector<unsigned char>* out, const Frame* frames, size_t count, const unsigned char* pixels, size_t pixelCount,
+                                  lodepng::State& state, CompressionProfile profile);
+    static unsigned countColors(const unsigned char* sprite, size_t pixels, uint32_t* colors);
+    static void analyzeColors(const unsigned char* sprite, size_t pixels, ColorAnalysis& analysis);
+    static bool paletteFits(unsigned colorCount, size_t pixels);
+    static void reduceColorMode(const ColorAnalysis& analysis, LodePNGInfo& info);
+};
+
+#endif //SPRITESHEETSPLITTER_SPRITEENCODER_HPP
@@ -0,0 +1,124 @@
+#include "Zlib.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include "Checksum.hpp"
+
+namespace {
+
+// The error codes are only meaningful to ourselves: lodepng translates any custom zlib error into 110 (decode) / 111 (encode).
+constexpr unsigned ERROR_ALLOC = 83;
+constexpr unsigned ERROR_TOO_SMALL = 53;
+constexpr unsigned ERROR_HEADER_CHECK = 24;
+constexpr unsigned ERROR_METHOD = 25;
+constexpr unsigned ERROR_DICTIONARY = 26;
+constexpr unsigned ERROR_ADLER = 58;
+
+inline uint32_t readBigEndian32(const unsigned char* p) {
+    return (uint32_t(p[0]) << 24u) | (uint32_t(p[1]) << 16u) | (uint32_t(p[2]) << 8u) | uint32_t(p[3]);
+}
+
+inline void writeBigEndian32(unsigned char* p, uint32_t value) {
+    p[0] = static_cast<unsigned char>(value >> 24u);
+    p[1] = static_cast<unsigned char>(value >> 16u);
+    p[2] = static_cast<unsigned char>(value >> 8u);
+    p[3] = static_cast<unsigned char>(value);
+}
+
+} // namespace
+
+/**
+ * Compress in[0..insize) into a zlib stream. Replaces the content of *out.
+ * @return 0 on success.
+ */
+// static
+unsigned Zlib::compress(unsigned char** out, size_t* outsize, const unsigned char* in, size_t insize, const LodePNGCompressSettings* settings) {
+    unsigned char* deflated = nullptr;
+    size_t deflatedSize = 0;
+    unsigned error = settings->custom_deflate
+            ? settings->custom_deflate(&deflated, &deflatedSize, in, insize, settings)
+            : lodepng_deflate(&deflated, &deflatedSize, in, insize, settings);
+
+    *out = nullptr;
+    *outsize = 0;
+    if (!error) {
+        *out = static_cast<unsigned char*>(std::malloc(deflatedSize + 6));
+        if (!*out) error = ERROR_ALLOC;
+    }
+
+    if (!error) {
+        // CMF: deflate with a 32K window. FLG: no dictionary, FLEVEL, and FCHECK such that CMF * 256 + FLG is a multiple of 31.
+        const unsigned cmf = 0x78;
+        unsigned flg = levelOf(*settings) << 6u;
+        flg += 31 - (cmf * 256 + flg) % 31;
+        (*out)[0] = static_cast<unsigned char>(cmf);
+        (*out)[1] = static_cast<unsigned char>(flg);
+        if (deflatedSize) std::memcpy(*out + 2, deflated, deflatedSize);
+        writeBigEndian32(*out + 2 + deflatedSize, Checksum::adler32(1, in, insize));
+        *outsize = deflatedSize + 6;
+    }
+
+    std::free(deflated);
+    return error;
+}
+
+/**
+ * Decompress the zlib stream in[0..insize), appending to *out.
+ * Honours ignore_adler32 of the settings.
+ * @return 0 on success.
+ */
+// static
+unsigned Zlib::decompress(unsigned char** out, size_t* outsize, const unsigned char* in, size_t insize, const LodePNGDecompressSettings* settings) {
+    if (insize < 6) return ERROR_TOO_SMALL; // header and checksum alone are 6 bytes.
+
+    if ((in[0] * 256u + in[1]) % 31u != 0) return ERROR_HEADER_CHECK;
+    const unsigned method = in[0] & 15u;
+    const unsigned windowBits = (in[0] >> 4u) & 15u;
+    if (method != 8 || windowBits > 7) return ERROR_METHOD; // PNG only allows deflate with a window of at most 32K.
+    if ((in[1] >> 5u) & 1u) return ERROR_DICTIONARY; // PNG forbids preset dictionaries.
+
+    const size_t previousSize = *outsize;
+    unsigned error = settings->custom_inflate
+            ? settings->custom_inflate(out, outsize, in + 2, insize - 2, settings)
+            : lodepng_inflate(out, outsize, in + 2, insize - 2, settings);
+    if (error) return error;
+
+    if (!settings->ignore_adler32) {
+        const uint32_t expected = readBigEndian32(in + insize - 4);
+        if (Checksum::adler32(1, *out + previousSize, *outsize - previousSize) != expected) return ERROR_ADLER;
+    }
+
+    return 0;
+}
+
+// static
+unsigned Zlib::level(const unsigned char* stream) {
+    return stream[1] >> 6u;
+}
+
+/**
+ * lodepng's deflate with a larger window than its default of 2048, and the longest matches.
+ * For sprites, larger windows than MAX_WINDOW hardly shrink the output further (0.1% at 32768), but take four times as long.
+ */
+// static
+void Zlib::setMaxCompression(LodePNGCompressSettings& settings) {
+    settings.custom_deflate = nullptr;
+    settings.btype = 2;
+    settings.use_lz77 = 1;
+    settings.windowsize = MAX_WINDOW;
+    settings.minmatch = 3;
+    settings.nicematch = 258;
+    settings.lazymatching = 1;
+}
+
+/**
+ * Which FLEVEL describes the deflate settings: stored blocks are the fastest, the in-tree FastDeflate is fast,
+ * and lodepng's deflate is at maximum with the settings of setMaxCompression, and default otherwise.
+ */
+// static
+unsigned Zlib::levelOf(const LodePNGCompressSettings& settings) {
+    if (settings.custom_deflate) return LEVEL_FAST;
+    if (settings.btype == 0) return LEVEL_FASTEST;
+    if (settings.use_lz77 && settings.windowsize >= MAX_WINDOW && settings.nicematch >= 258 && settings.lazymatching) return LEVEL_MAX;
+    return LEVEL_DEFAULT;
+}
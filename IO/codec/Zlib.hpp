@@ -0,0 +1,40 @@
+#ifndef SPRITESHEETSPLITTER_ZLIB_HPP
+#define SPRITESHEETSPLITTER_ZLIB_HPP
+
+#include "lodepng.h"
+
+/**
+ * The zlib (RFC 1950) container around deflate data, plugged into lodepng through the custom_zlib hooks.
+ *
+ * Behaves like lodepng's own zlib functions, but checksums with Checksum::adler32.
+ * The deflate/inflate step itself is still delegated: to custom_deflate / custom_inflate when those are set,
+ * or to lodepng's built-in implementation otherwise.
+ */
+class Zlib {
+public:
+    // FLEVEL of the zlib header (RFC 1950): 0 fastest .. 3 maximum compression. Written from the deflate settings used.
+    static constexpr unsigned LEVEL_FASTEST = 0;
+    static constexpr unsigned LEVEL_FAST = 1;
+    static constexpr unsigned LEVEL_DEFAULT = 2;
+    static constexpr unsigned LEVEL_MAX = 3;
+
+    // Signature of LodePNGCompressSettings::custom_zlib.
+    static unsigned compress(unsigned char** out, size_t* outsize,
+                             const unsigned char* in, size_t insize,
+                             const LodePNGCompressSettings* settings);
+    // Signature of LodePNGDecompressSettings::custom_zlib. Appends to *out, like lodepng does.
+    static unsigned decompress(unsigned char** out, size_t* outsize,
+                               const unsigned char* in, size_t insize,
+                               const LodePNGDecompressSettings* settings);
+    // The FLEVEL of a zlib stream. The stream must be at least 2 bytes.
+    static unsigned level(const unsigned char* stream);
+    // Settings for lodepng's deflate that compress the most, and are written as LEVEL_MAX.
+    static void setMaxCompression(LodePNGCompressSettings& settings);
+
+private:
+    static constexpr unsigned MAX_WINDOW = 8192;
+
+    static unsigned levelOf(const LodePNGCompressSettings& settings);
+};
+
+#endif //SPRITESHEETSPLITTER_ZLIB_HPP
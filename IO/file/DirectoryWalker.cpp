@@ -0,0 +1,169 @@
+#include "DirectoryWalker.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#if defined(SPLITTER_LINUX_IO)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <filesystem>
+#endif
+
+namespace {
+
+#if defined(SPLITTER_LINUX_IO)
+// The record getdents64 fills the buffer with. glibc has no declaration of it.
+struct linux_dirent64 {
+    ino64_t d_ino;
+    off64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+#endif
+
+bool endsWith(const char* name, size_t length, const std::string& suffix) {
+    return length > suffix.size() && std::memcmp(name + length - suffix.size(), suffix.data(), suffix.size()) == 0;
+}
+
+#if defined(SPLITTER_LINUX_IO)
+// Whether a symbolic link leads to a file: not to a folder, and not nowhere.
+bool linksToFile(int folder, const char* name) {
+    struct stat st {};
+    return fstatat(folder, name, &st, 0) == 0 && S_ISREG(st.st_mode);
+}
+#endif
+
+} // namespace
+
+/**
+ * What the threads of one walk share: the folders still to read, and what was found so far.
+ */
+struct DirectoryWalker::Walk {
+    Walk(const std::string& extension, PathArena& files) : extension(extension), files(files) {}
+
+    const std::string& extension;
+    PathArena& files;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::string> pending; // folders to read. A stack: the walk goes deep first, and keeps it short.
+    unsigned int busy = 0; // threads reading a folder, that may add to pending.
+    std::vector<Failure> failures;
+};
+
+/**
+ * Every thread, the caller included, takes folders from pending until there are none, and none are being read.
+ * The result is sorted, as the order in which folders are read differs between runs.
+ */
+void DirectoryWalker::walk(const std::string& extension, PathArena& files, std::vector<Failure>& failures) const {
+    Walk walk(extension, files);
+    walk.pending.push_back(root_);
+
+    std::vector<std::thread> threads;
+    const unsigned int count = recursive_ ? std::clamp(std::thread::hardware_concurrency(), 2u, MAX_THREADS) : 1;
+    for (unsigned int i = 1; i < count; ++i) threads.emplace_back(&DirectoryWalker::work, this, std::ref(walk));
+    work(walk);
+    for (std::thread& thread : threads) thread.join();
+
+    files.sort();
+    failures = std::move(walk.failures);
+}
+
+void DirectoryWalker::work(Walk& walk) const {
+    std::vector<char> buffer(BUFFER_SIZE);
+    std::unique_lock<std::mutex> lock(walk.mutex);
+    while (true) {
+        walk.changed.wait(lock, [&walk] { return !walk.pending.empty() || walk.busy == 0; });
+        if (walk.pending.empty()) break; // and nobody can add to it anymore.
+
+        std::string folder = std::move(walk.pending.back());
+        walk.pending.pop_back();
+        ++walk.busy;
+        lock.unlock();
+        read(folder, walk, buffer);
+        lock.lock();
+        --walk.busy;
+        walk.changed.notify_all();
+    }
+}
+
+/**
+ * Read one folder. Its files and subfolders are collected here, and handed to the walk in one go at the end.
+ */
+void DirectoryWalker::read(const std::string& folder, Walk& walk, [[maybe_unused]] std::vector<char>& buffer) const {
+    std::string names; // of the files, back to back.
+    std::vector<size_t> nameSizes;
+    std::vector<std::string> folders;
+    int error = 0;
+    const std::string prefix = folder.empty() || folder.back() == '/' ? folder : folder + '/';
+
+#if defined(SPLITTER_LINUX_IO)
+    const int fd = ::open(folder.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) error = errno;
+
+    while (fd >= 0) {
+        const long size = syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+        if (size <= 0) {
+            if (size < 0) error = errno;
+            break;
+        }
+        for (long offset = 0; offset < size;) {
+            const auto* entry = reinterpret_cast<const linux_dirent64*>(buffer.data() + offset);
+            offset += entry->d_reclen;
+            const char* name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+            unsigned char type = entry->d_type;
+            if (type == DT_UNKNOWN) {
+                struct stat st {};
+                if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue; // gone since.
+                type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISLNK(st.st_mode) ? DT_LNK : S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+            }
+            const size_t length = std::strlen(name);
+            if (type == DT_DIR) {
+                if (recursive_ && std::find(skippedFolders_.begin(), skippedFolders_.end(), name) == skippedFolders_.end()) {
+                    folders.emplace_back(prefix).append(name, length);
+                }
+            } else if (endsWith(name, length, walk.extension) && (type == DT_REG || (type == DT_LNK && linksToFile(fd, name)))) {
+                names.append(name, length);
+                nameSizes.push_back(length);
+            }
+        }
+    }
+    if (fd >= 0) ::close(fd);
+#else
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(folder.empty() ? "." : folder, ec), end; !ec && it != end; it.increment(ec)) {
+        const std::string name = it->path().filename().string();
+        std::error_code typeError; // gone since: skipped.
+        if (it->is_directory(typeError) && !it->is_symlink(typeError)) {
+            if (recursive_ && std::find(skippedFolders_.begin(), skippedFolders_.end(), name) == skippedFolders_.end()) {
+                folders.push_back(prefix + name);
+            }
+        } else if (it->is_regular_file(typeError) && endsWith(name.c_str(), name.size(), walk.extension)) {
+            names.append(name);
+            nameSizes.push_back(name.size());
+        }
+    }
+    if (ec) error = ec.default_error_condition().value();
+#endif
+
+    std::lock_guard<std::mutex> lock(walk.mutex);
+    if (error) walk.failures.push_back({folder, error});
+    if (! nameSizes.empty()) {
+        const PathArena::Folder added = walk.files.addFolder(prefix);
+        std::string_view rest = names;
+        for (size_t size : nameSizes) {
+            walk.files.add(added, rest.substr(0, size));
+            rest.remove_prefix(size);
+        }
+    }
+    walk.pending.insert(walk.pending.end(), std::make_move_iterator(folders.begin()), std::make_move_iterator(folders.end()));
+}
@@ -0,0 +1,50 @@
+#ifndef SPRITESHEETSPLITTER_DIRECTORYWALKER_HPP
+#define SPRITESHEETSPLITTER_DIRECTORYWALKER_HPP
+
+#include <string>
+#include <vector>
+#include "PathArena.hpp"
+#include "Platform.hpp"
+
+/**
+ * Finds the files with an extension in a folder, and if recursive in every folder below it, reading folders concurrently.
+ *
+ * Folders are read with getdents64, a buffer of entries per call, and the type of an entry is taken from d_type: a stat
+ * is only needed on filesystems that do not fill it in. Names are matched as they come: matching files go into a
+ * PathArena, a folder once and its files by name, and only folders to descend into are turned into paths.
+ *
+ * Without SPLITTER_LINUX_IO (see Platform.hpp), folders are read with std::filesystem instead, which asks for the type of each entry.
+ *
+ * Symbolic links to files are followed, those to folders are not, and dangling ones are skipped.
+ * Folders with one of the skipped names are not read.
+ */
+class DirectoryWalker {
+public:
+    struct Failure {
+        std::string path;
+        int error; // errno
+    };
+
+    DirectoryWalker(std::string root, bool recursive, std::vector<std::string> skippedFolders)
+        : root_(std::move(root)), recursive_(recursive), skippedFolders_(std::move(skippedFolders)) {}
+
+    /**
+     * Add the files whose name ends in extension to files, as root followed by their path below it, and sort files.
+     * @param failures receives the folders that could not be read. The walk goes on without them.
+     */
+    void walk(const std::string& extension, PathArena& files, std::vector<Failure>& failures) const;
+
+private:
+    static constexpr unsigned int MAX_THREADS = 8; // reading folders waits on the disk more than on a core.
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    std::string root_;
+    bool recursive_;
+    std::vector<std::string> skippedFolders_;
+
+    struct Walk;
+    void read(const std::string& folder, Walk& walk, std::vector<char>& buffer) const;
+    void work(Walk& walk) const;
+};
+
+#endif //SPRITESHEETSPLITTER_DIRECTORYWALKER_HPP
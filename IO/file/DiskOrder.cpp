@@ -0,0 +1,116 @@
+#include "DiskOrder.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <sys/stat.h>
+#if defined(SPLITTER_LINUX_IO)
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Files that cannot be looked at go last, in the order they were in.
+constexpr uint64_t UNKNOWN = std::numeric_limits<uint64_t>::max();
+}
+
+/**
+ * With EXTENT, any file whose filesystem has no FIEMAP stops the lookup: all files are then sorted by inode,
+ * as positions from two kinds of key cannot be compared.
+ */
+// static
+DiskOrder::Report DiskOrder::sort(PathArena& files, size_t count, ReadOrder order) {
+    count = std::min(count, files.size());
+    Report report {order, count, false, 0, 0};
+    if (order == ReadOrder::PATH || count < 2) return report;
+
+    std::vector<Position> positions(count, {UNKNOWN, UNKNOWN});
+    std::string path;
+    if (order == ReadOrder::EXTENT) {
+        for (size_t i = 0; i < count; ++i) {
+            bool unsupported = false;
+            files.path(i, path);
+            if (!extentPosition(path.c_str(), positions[i], unsupported) && unsupported) {
+                report.order = ReadOrder::INODE;
+                break;
+            }
+        }
+    }
+    if (report.order == ReadOrder::INODE) {
+        for (size_t i = 0; i < count; ++i) {
+            files.path(i, path);
+            if (!inodePosition(path.c_str(), positions[i])) positions[i] = {UNKNOWN, UNKNOWN};
+        }
+    }
+
+    std::vector<size_t> sorted(count);
+    std::iota(sorted.begin(), sorted.end(), 0);
+    report.distanceKnown = report.order == ReadOrder::EXTENT;
+    if (report.distanceKnown) report.distanceBefore = distance(positions, sorted);
+
+    std::stable_sort(sorted.begin(), sorted.end(), [&positions](size_t a, size_t b) { return positions[a].key < positions[b].key; });
+    if (report.distanceKnown) report.distanceAfter = distance(positions, sorted);
+    files.permute(sorted);
+    return report;
+}
+
+/**
+ * Only the first extent is asked for: where a file starts decides where reading it starts.
+ * @param unsupported set when the filesystem has no FIEMAP at all, rather than this file failing. Always, without SPLITTER_LINUX_IO.
+ */
+// static
+bool DiskOrder::extentPosition([[maybe_unused]] const char* path, [[maybe_unused]] Position& position, bool& unsupported) {
+#if !defined(SPLITTER_LINUX_IO)
+    unsupported = true;
+    return false;
+#else
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st {};
+    alignas(struct fiemap) unsigned char buffer[sizeof(struct fiemap) + sizeof(struct fiemap_extent)] = {};
+    auto* map = reinterpret_cast<struct fiemap*>(buffer);
+    map->fm_start = 0;
+    map->fm_length = FIEMAP_MAX_OFFSET;
+    map->fm_extent_count = 1;
+    const bool ok = fstat(fd, &st) == 0 && ioctl(fd, FS_IOC_FIEMAP, map) == 0;
+    if (!ok) unsupported = errno == EOPNOTSUPP || errno == ENOTTY;
+    ::close(fd);
+    if (!ok) return false;
+
+    if (map->fm_mapped_extents == 0) { // empty, or the data lives in the inode.
+        position = {0, 0};
+        return true;
+    }
+    const struct fiemap_extent& extent = map->fm_extents[0];
+    if (extent.fe_flags & (FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DELALLOC)) return false; // not on disk yet: nothing to sort by.
+    position = {extent.fe_physical, extent.fe_physical + static_cast<uint64_t>(st.st_size)};
+    return true;
+#endif
+}
+
+// static
+bool DiskOrder::inodePosition(const char* path, Position& position) {
+    struct stat st {};
+    if (stat(path, &st) != 0) return false;
+    position = {static_cast<uint64_t>(st.st_ino), UNKNOWN};
+    return true;
+}
+
+// static
+uint64_t DiskOrder::distance(const std::vector<Position>& positions, const std::vector<size_t>& order) {
+    uint64_t total = 0;
+    const Position* previous = nullptr;
+    for (size_t index : order) {
+        const Position& position = positions[index];
+        if (position.key == UNKNOWN) continue;
+        if (previous) total += position.key > previous->end ? position.key - previous->end : previous->end - position.key;
+        previous = &position;
+    }
+    return total;
+}
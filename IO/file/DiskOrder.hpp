@@ -0,0 +1,46 @@
+#ifndef SPRITESHEETSPLITTER_DISKORDER_HPP
+#define SPRITESHEETSPLITTER_DISKORDER_HPP
+
+#include <cstdint>
+#include <vector>
+#include "PathArena.hpp"
+#include "Platform.hpp"
+#include "../../util/ReadOrder.h"
+
+/**
+ * Orders files by where they are on disk, so that reading them one after another on cold storage comes close to one
+ * sequential read instead of a seek per file.
+ *
+ * INODE sorts by inode number, from a stat per file: most filesystems allocate the data of a file close to its inode.
+ * EXTENT sorts by the physical offset of the first extent of each file, from a FIEMAP per file. Filesystems without
+ * FIEMAP (e.g. tmpfs, most network filesystems) are sorted by inode instead, and so is every filesystem without
+ * SPLITTER_LINUX_IO (see Platform.hpp). Where stat has no inode numbers (Windows), the files keep their order.
+ */
+class DiskOrder {
+public:
+    struct Report {
+        ReadOrder order; // the order used: EXTENT becomes INODE without FIEMAP.
+        size_t sorted; // the files ordered.
+        bool distanceKnown; // only with EXTENT: whether the distances below are set.
+        uint64_t distanceBefore; // bytes on disk between the end of a file and the start of the next, summed, in the order before.
+        uint64_t distanceAfter; // the same, in the new order.
+    };
+
+    /**
+     * Sort files[0, count) by order. Files beyond count keep their place, and ties and files that cannot be
+     * looked at keep their order relative to each other.
+     */
+    static Report sort(PathArena& files, size_t count, ReadOrder order);
+
+private:
+    struct Position {
+        uint64_t key; // the inode, or the physical offset of the first extent.
+        uint64_t end; // with EXTENT: the physical offset after the file, as if it were contiguous.
+    };
+
+    static bool extentPosition(const char* path, Position& position, bool& unsupported);
+    static bool inodePosition(const char* path, Position& position);
+    static uint64_t distance(const std::vector<Position>& positions, const std::vector<size_t>& order);
+};
+
+#endif //SPRITESHEETSPLITTER_DISKORDER_HPP
@@ -0,0 +1,41 @@
+#include "FileList.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+#include "MappedFile.hpp"
+
+// static
+bool FileList::read(const std::string& listPath, const std::string& base, const std::string& extension, PathArena& files, std::string& error) {
+    MappedFile list;
+    const bool opened = listPath == STDIN ? list.openStandardInput(MappedFile::Access::SEQUENTIAL) : list.open(listPath, MappedFile::Access::SEQUENTIAL);
+    if (!opened) {
+        error = "cannot read the file list " + listPath + ": " + std::strerror(errno);
+        return false;
+    }
+
+    if (list.size() == 0) return true; // data() may be null, which memchr must not be given.
+
+    const auto* begin = reinterpret_cast<const char*>(list.data());
+    const char* end = begin + list.size();
+    const char separator = std::memchr(begin, '\0', list.size()) ? '\0' : '\n';
+    const std::string prefix = base.empty() || base.back() == '/' ? base : base + '/';
+    std::string relative; // reused: only relative paths are put together.
+
+    for (const char* p = begin; p < end;) {
+        const auto* next = static_cast<const char*>(std::memchr(p, separator, end - p));
+        if (!next) next = end;
+        std::string_view entry(p, next - p);
+        p = next + 1;
+
+        if (separator == '\n' && !entry.empty() && entry.back() == '\r') entry.remove_suffix(1);
+        if (entry.size() <= extension.size() || entry.substr(entry.size() - extension.size()) != extension) continue;
+        if (entry.front() == '/') {
+            files.addPath(entry);
+        } else {
+            relative.assign(prefix).append(entry);
+            files.addPath(relative);
+        }
+    }
+    return true;
+}
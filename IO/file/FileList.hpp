@@ -0,0 +1,26 @@
+#ifndef SPRITESHEETSPLITTER_FILELIST_HPP
+#define SPRITESHEETSPLITTER_FILELIST_HPP
+
+#include <string>
+#include "PathArena.hpp"
+
+/**
+ * Reads the files to work on from a list, e.g. the sheets a version control diff says changed, instead of searching folders.
+ *
+ * The list is mapped (or, from a pipe, read) and parsed in place: paths separated by NUL if the list holds one,
+ * as written by e.g. `git diff -z --name-only`, and by newlines otherwise. Absolute paths are copied straight from
+ * the list into the PathArena; consecutive paths in the same folder share it.
+ */
+class FileList {
+public:
+    static constexpr const char* STDIN = "-";
+
+    /**
+     * Add the paths in the list at listPath (STDIN for standard input) that end in extension to files, in the order listed.
+     * Relative paths are taken relative to base. Empty lines, and a '\r' before a newline, are skipped.
+     * @return false, with the reason in error, if the list cannot be read.
+     */
+    static bool read(const std::string& listPath, const std::string& base, const std::string& extension, PathArena& files, std::string& error);
+};
+
+#endif //SPRITESHEETSPLITTER_FILELIST_HPP
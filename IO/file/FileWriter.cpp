@@ -0,0 +1,129 @@
+#include "FileWriter.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#if defined(SPLITTER_LINUX_IO)
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <cstdio>
+#endif
+#if defined(SPLITTER_IO_URING)
+#include "UringWriter.hpp"
+#endif
+
+// static
+std::unique_ptr<FileWriter> FileWriter::create(WriteBackend backend, std::string& fallbackReason) {
+    switch (backend) {
+        case WriteBackend::URING: {
+#if defined(SPLITTER_IO_URING)
+            std::unique_ptr<FileWriter> uring = UringWriter::create(fallbackReason);
+            if (uring) return uring;
+#else
+            fallbackReason = "this build has no io_uring";
+#endif
+            return std::make_unique<PoolWriter>();
+        }
+        case WriteBackend::POOL:
+            return std::make_unique<PoolWriter>();
+        case WriteBackend::SYNC:
+        default:
+            return nullptr;
+    }
+}
+
+void FileWriter::write(std::shared_ptr<const OutputFolder> folder, std::string_view name, std::vector<unsigned char>&& data) {
+    Request request {std::move(folder), {}, std::move(data)};
+    name.copy(request.name, MAX_NAME);
+    request.name[std::min(name.size(), MAX_NAME)] = '\0';
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // a single file larger than the bound still goes through, once everything before it is written.
+    progress_.wait(lock, [this] { return pendingBytes_ < MAX_QUEUED_BYTES; });
+    pending_ += 1;
+    pendingBytes_ += request.data.size();
+    queue_.push_back(std::move(request));
+    workAvailable_.notify_one();
+}
+
+std::vector<FileWriter::Failure> FileWriter::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    progress_.wait(lock, [this] { return pending_ == 0; });
+    std::vector<Failure> failures;
+    failures.swap(failures_);
+    return failures;
+}
+
+void FileWriter::complete(Request& request, int error) {
+    if (error) failures_.push_back({request.folder, request.folder->path() + '/' + request.name, error});
+    pending_ -= 1;
+    pendingBytes_ -= request.data.size();
+    std::vector<unsigned char>().swap(request.data);
+    request.folder.reset();
+    progress_.notify_all();
+}
+
+void FileWriter::stop(std::vector<std::thread>& threads) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    workAvailable_.notify_all();
+    for (std::thread& thread : threads) thread.join();
+    threads.clear();
+}
+
+// static
+int FileWriter::writeFile(const OutputFolder& folder, const char* name, const unsigned char* data, size_t size) {
+#if defined(SPLITTER_LINUX_IO)
+    // 0666 and the umask, as fopen (and so lodepng::save_file) creates files.
+    const int fd = openat(folder.fd(), name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) return errno;
+
+    int error = 0;
+    size_t done = 0;
+    while (done < size) {
+        const ssize_t n = pwrite(fd, data + done, size - done, static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            error = n < 0 ? errno : EIO;
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    if (::close(fd) != 0 && !error) error = errno;
+    return error;
+#else
+    // as lodepng::save_file does. stdio need not set errno: EIO when it does not.
+    errno = 0;
+    std::FILE* file = std::fopen((folder.path() + '/' + name).c_str(), "wb");
+    if (!file) return errno ? errno : EIO;
+    int error = std::fwrite(data, 1, size, file) == size ? 0 : (errno ? errno : EIO);
+    if (std::fclose(file) != 0 && !error) error = errno ? errno : EIO;
+    return error;
+#endif
+}
+
+PoolWriter::PoolWriter() {
+    const unsigned int count = std::clamp(std::thread::hardware_concurrency(), 1u, MAX_THREADS);
+    for (unsigned int i = 0; i < count; ++i) threads_.emplace_back(&PoolWriter::run, this);
+}
+
+PoolWriter::~PoolWriter() {
+    stop(threads_);
+}
+
+void PoolWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        workAvailable_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) return; // stopping, and nothing left.
+
+        Request request = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        const int error = writeFile(request);
+        lock.lock();
+        complete(request, error);
+    }
+}
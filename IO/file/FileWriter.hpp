@@ -0,0 +1,93 @@
+#ifndef SPRITESHEETSPLITTER_FILEWRITER_HPP
+#define SPRITESHEETSPLITTER_FILEWRITER_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "OutputFolder.hpp"
+#include "../../util/WriteBackend.h"
+
+/**
+ * Writes files in the background, for the workers that encode sprites: write() queues a file and returns,
+ * and the open, write and close happen elsewhere. The writer owns the contents until the file is written.
+ *
+ * The queue is bounded by MAX_QUEUED_BYTES. Only when the filesystem falls that far behind does write() block.
+ * Failures are collected, and handed out by wait().
+ */
+class FileWriter {
+public:
+    struct Failure {
+        std::shared_ptr<const OutputFolder> folder; // the file was to go in.
+        std::string path;
+        int error; // errno
+    };
+
+    static constexpr size_t MAX_QUEUED_BYTES = 64 * 1024 * 1024;
+    static constexpr size_t MAX_NAME = 63; // file names are kept in the request: a sprite name and an extension fit.
+
+    /**
+     * The writer of a backend: nullptr for SYNC. For URING, a POOL writer if io_uring cannot be set up here,
+     * or this build has no io_uring (see Platform.hpp), with the reason in fallbackReason.
+     */
+    static std::unique_ptr<FileWriter> create(WriteBackend backend, std::string& fallbackReason);
+
+    FileWriter() = default;
+    virtual ~FileWriter() = default;
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    // Queue a file to be created (or truncated) in folder with data as its contents. Thread safe. name has at most MAX_NAME characters.
+    void write(std::shared_ptr<const OutputFolder> folder, std::string_view name, std::vector<unsigned char>&& data);
+    // Wait until every queued file is written. Returns the files that failed since the last wait.
+    std::vector<Failure> wait();
+    [[nodiscard]] virtual WriteBackend backend() const = 0;
+
+    // Create (or truncate) a file in a folder, and write data to it, with plain syscalls. Returns 0, or the errno of the step that failed.
+    static int writeFile(const OutputFolder& folder, const char* name, const unsigned char* data, size_t size);
+
+protected:
+    struct Request {
+        std::shared_ptr<const OutputFolder> folder;
+        char name[MAX_NAME + 1]; // NUL terminated.
+        std::vector<unsigned char> data;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable workAvailable_; // the queue got a request, or stopping_ was set.
+    std::deque<Request> queue_;
+    bool stopping_ = false;
+
+    // Count a request as done, releasing its contents. Expects mutex_ to be held.
+    void complete(Request& request, int error);
+    // Stop and join the threads of the writer. Derived classes call this first thing in their destructor.
+    void stop(std::vector<std::thread>& threads);
+    static int writeFile(const Request& request) { return writeFile(*request.folder, request.name, request.data.data(), request.data.size()); }
+
+private:
+    std::condition_variable progress_; // a request completed.
+    size_t pending_ = 0; // queued or in flight.
+    size_t pendingBytes_ = 0;
+    std::vector<Failure> failures_;
+};
+
+// Writes files from a few threads of its own, each with plain open, pwrite and close.
+class PoolWriter : public FileWriter {
+public:
+    static constexpr unsigned int MAX_THREADS = 4; // more threads do not write faster to one disk.
+
+    PoolWriter();
+    ~PoolWriter() override;
+    [[nodiscard]] WriteBackend backend() const override { return WriteBackend::POOL; }
+
+private:
+    std::vector<std::thread> threads_;
+
+    void run();
+};
+
+#endif //SPRITESHEETSPLITTER_FILEWRITER_HPP
@@ -0,0 +1,137 @@
+#include "MappedFile.hpp"
+
+#include <cerrno>
+#if defined(SPLITTER_LINUX_IO)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#if defined(SPLITTER_LINUX_IO)
+
+bool MappedFile::open(const std::string& fileName, Access access) {
+    close();
+
+    const int fd = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    const bool ok = load(fd, access);
+    const int error = errno; // of the failure, if any: not of the cleanup.
+    ::close(fd);
+    errno = error;
+    return ok;
+}
+
+bool MappedFile::openStandardInput(Access access) {
+    close();
+    return load(STDIN_FILENO, access);
+}
+
+void MappedFile::close() {
+    if (mapped_) munmap(const_cast<unsigned char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    buffer_.clear();
+}
+
+// Map the file if it is a regular file, and read it otherwise.
+bool MappedFile::load(int fd, Access access) {
+    struct stat st {};
+    if (fstat(fd, &st) != 0) return false;
+
+    bool ok = false;
+    if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        size_ = static_cast<size_t>(st.st_size);
+        void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            if (access == Access::SEQUENTIAL) madvise(map, size_, MADV_SEQUENTIAL); // only advice: failing changes nothing.
+            data_ = static_cast<const unsigned char*>(map);
+            mapped_ = true;
+            ok = true;
+        }
+    }
+    if (!ok) ok = read(fd, S_ISREG(st.st_mode) ? static_cast<size_t>(st.st_size) : 0);
+
+    if (!ok) {
+        const int error = errno;
+        close();
+        errno = error;
+    }
+    return ok;
+}
+
+/**
+ * Read the file up to its end. Short reads are continued, so this also works for pipes, where the size is not known up front.
+ * @param sizeHint the expected size, or 0 if unknown.
+ */
+bool MappedFile::read(int fd, size_t sizeHint) {
+    constexpr size_t CHUNK = 64 * 1024;
+    buffer_.resize(sizeHint > 0 ? sizeHint : CHUNK);
+    size_t done = 0;
+    while (true) {
+        if (done == buffer_.size()) buffer_.resize(buffer_.size() + CHUNK);
+        const ssize_t n = ::read(fd, buffer_.data() + done, buffer_.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return false;
+        if (n == 0) break;
+        done += static_cast<size_t>(n);
+    }
+    buffer_.resize(done);
+    data_ = buffer_.data();
+    size_ = done;
+    return true;
+}
+
+#else
+
+bool MappedFile::open(const std::string& fileName, Access) {
+    close();
+
+    std::FILE* file = std::fopen(fileName.c_str(), "rb");
+    if (!file) return false;
+    const bool ok = read(file);
+    const int error = errno;
+    std::fclose(file);
+    errno = error;
+    return ok;
+}
+
+bool MappedFile::openStandardInput(Access) {
+    close();
+    return read(stdin);
+}
+
+void MappedFile::close() {
+    data_ = nullptr;
+    size_ = 0;
+    buffer_.clear();
+}
+
+// Read the file up to its end, in chunks: the size of standard input is not known up front.
+bool MappedFile::read(std::FILE* file) {
+    constexpr size_t CHUNK = 64 * 1024;
+    size_t done = 0;
+    while (true) {
+        buffer_.resize(done + CHUNK);
+        const size_t n = std::fread(buffer_.data() + done, 1, CHUNK, file);
+        done += n;
+        if (n < CHUNK) break;
+    }
+    if (std::ferror(file)) {
+        const int error = errno;
+        close();
+        errno = error;
+        return false;
+    }
+    buffer_.resize(done);
+    data_ = buffer_.data();
+    size_ = done;
+    return true;
+}
+
+#endif
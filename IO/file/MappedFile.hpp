@@ -0,0 +1,57 @@
+#ifndef SPRITESHEETSPLITTER_MAPPEDFILE_HPP
+#define SPRITESHEETSPLITTER_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Platform.hpp"
+
+/**
+ * A file mapped read-only into memory, for decoding straight from the page cache: no buffer the size of the file
+ * is allocated and filled per file, and pages already cached by an earlier run are used as they are.
+ *
+ * When a file cannot be mapped (a pipe, an empty file, some network filesystems), it is read into memory instead,
+ * with buffered reads that go on after short reads. Either way, data() holds the whole file.
+ * Files are only mapped on Linux (see Platform.hpp): elsewhere, they are always read.
+ *
+ * A mapped file that is truncated by someone else while mapped raises SIGBUS on access. The input sheets are not written
+ * while splitting, and a sheet that is replaced (renamed over) keeps the old inode alive for the mapping.
+ */
+class MappedFile {
+public:
+    enum class Access {
+        NORMAL,
+        SEQUENTIAL, // read front to back once: the kernel reads ahead further, and may drop pages behind.
+    };
+
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map (or read) the file. Returns false, with errno set, if it cannot be opened or read. Closes what was open before.
+    bool open(const std::string& fileName, Access access);
+    // The same for standard input, which stays open.
+    bool openStandardInput(Access access);
+    void close();
+
+    [[nodiscard]] const unsigned char* data() const { return data_; }
+    [[nodiscard]] size_t size() const { return size_; }
+    [[nodiscard]] bool mapped() const { return mapped_; }
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false; // data_ is an mmap, rather than pointing into buffer_.
+    std::vector<unsigned char> buffer_; // the file contents, if mapping it failed.
+
+#if defined(SPLITTER_LINUX_IO)
+    bool load(int fd, Access access);
+    bool read(int fd, size_t sizeHint);
+#else
+    bool read(std::FILE* file);
+#endif
+};
+
+#endif //SPRITESHEETSPLITTER_MAPPEDFILE_HPP
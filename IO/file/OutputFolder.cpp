@@ -0,0 +1,35 @@
+#include "OutputFolder.hpp"
+
+#include <cerrno>
+#if defined(SPLITTER_LINUX_IO)
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <filesystem>
+#endif
+
+// static
+std::shared_ptr<const OutputFolder> OutputFolder::open(const std::string& path, int& error) {
+#if defined(SPLITTER_LINUX_IO)
+    const int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        error = errno;
+        return nullptr;
+    }
+#else
+    const int fd = -1;
+    std::error_code ec;
+    if (!std::filesystem::is_directory(path, ec)) {
+        error = ec ? ec.default_error_condition().value() : ENOTDIR;
+        return nullptr;
+    }
+#endif
+    error = 0;
+    return std::shared_ptr<const OutputFolder>(new OutputFolder(fd, path));
+}
+
+OutputFolder::~OutputFolder() {
+#if defined(SPLITTER_LINUX_IO)
+    ::close(fd_);
+#endif
+}
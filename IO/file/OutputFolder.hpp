@@ -0,0 +1,34 @@
+#ifndef SPRITESHEETSPLITTER_OUTPUTFOLDER_HPP
+#define SPRITESHEETSPLITTER_OUTPUTFOLDER_HPP
+
+#include <memory>
+#include <string>
+#include "Platform.hpp"
+
+/**
+ * An output folder, opened once: files are created in it with openat and their bare name,
+ * so the kernel does not look up the whole path of the folder again for every file.
+ * Without SPLITTER_LINUX_IO (see Platform.hpp), nothing is held open: fd() is -1, and files are created by their path.
+ *
+ * Shared by the files queued in a FileWriter, which keep it open until they are written.
+ */
+class OutputFolder {
+public:
+    // Open the folder, which has to exist. Returns nullptr, with the errno in error, if it cannot be opened (or is no folder).
+    static std::shared_ptr<const OutputFolder> open(const std::string& path, int& error);
+
+    ~OutputFolder();
+    OutputFolder(const OutputFolder&) = delete;
+    OutputFolder& operator=(const OutputFolder&) = delete;
+
+    [[nodiscard]] int fd() const { return fd_; }
+    [[nodiscard]] const std::string& path() const { return path_; }
+
+private:
+    int fd_;
+    std::string path_; // for messages.
+
+    OutputFolder(int fd, std::string path) : fd_(fd), path_(std::move(path)) {}
+};
+
+#endif //SPRITESHEETSPLITTER_OUTPUTFOLDER_HPP
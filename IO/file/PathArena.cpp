@@ -0,0 +1,72 @@
+#include "PathArena.hpp"
+
+#include <algorithm>
+
+PathArena::Folder PathArena::addFolder(std::string_view prefix) {
+    folders_.push_back({append(prefix), static_cast<uint32_t>(prefix.size())});
+    return static_cast<Folder>(folders_.size() - 1);
+}
+
+void PathArena::add(Folder folder, std::string_view name) {
+    files_.push_back({append(name), folder, static_cast<uint32_t>(name.size())});
+}
+
+void PathArena::addPath(std::string_view path) {
+    const size_t separator = path.rfind('/');
+    const size_t split = separator == std::string_view::npos ? 0 : separator + 1;
+    const std::string_view folder = path.substr(0, split);
+    if (folders_.empty() || view(folders_.back().offset, folders_.back().size) != folder) addFolder(folder);
+    add(static_cast<Folder>(folders_.size() - 1), path.substr(split));
+}
+
+std::string_view PathArena::folder(size_t index) const {
+    const Slice& folder = folders_[files_[index].folder];
+    return view(folder.offset, folder.size);
+}
+
+std::string_view PathArena::name(size_t index) const {
+    return view(files_[index].nameOffset, files_[index].nameSize);
+}
+
+std::string PathArena::path(size_t index) const {
+    std::string out;
+    path(index, out);
+    return out;
+}
+
+void PathArena::path(size_t index, std::string& out) const {
+    const std::string_view folder = this->folder(index);
+    const std::string_view name = this->name(index);
+    out.reserve(folder.size() + name.size());
+    out.assign(folder).append(name);
+}
+
+/**
+ * Folders are ranked once, so files compare by two integers where they can, and by name only within a folder.
+ */
+void PathArena::sort() {
+    std::vector<Folder> byPath(folders_.size());
+    for (Folder f = 0; f < byPath.size(); ++f) byPath[f] = f;
+    std::sort(byPath.begin(), byPath.end(), [this](Folder a, Folder b) {
+        return view(folders_[a].offset, folders_[a].size) < view(folders_[b].offset, folders_[b].size);
+    });
+    std::vector<Folder> rank(folders_.size());
+    for (Folder r = 0; r < byPath.size(); ++r) rank[byPath[r]] = r;
+
+    std::sort(files_.begin(), files_.end(), [this, &rank](const File& a, const File& b) {
+        if (a.folder != b.folder) return rank[a.folder] < rank[b.folder];
+        return view(a.nameOffset, a.nameSize) < view(b.nameOffset, b.nameSize);
+    });
+}
+
+void PathArena::permute(const std::vector<size_t>& order) {
+    std::vector<File> permuted(order.size());
+    for (size_t i = 0; i < order.size(); ++i) permuted[i] = files_[order[i]];
+    std::copy(permuted.begin(), permuted.end(), files_.begin());
+}
+
+uint64_t PathArena::append(std::string_view s) {
+    const uint64_t offset = chars_.size();
+    chars_.insert(chars_.end(), s.begin(), s.end());
+    return offset;
+}
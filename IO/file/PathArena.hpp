@@ -0,0 +1,59 @@
+#ifndef SPRITESHEETSPLITTER_PATHARENA_HPP
+#define SPRITESHEETSPLITTER_PATHARENA_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * A list of file paths, stored compactly: the folder of a file is stored once, in a table of folders, and the file
+ * itself as a slice of one arena of names. A file costs an entry of 16 bytes and its name, instead of a std::string
+ * of its whole path and the allocation behind it. Files are addressed by index, and their path is put together
+ * only when asked for, e.g. when the file is opened.
+ *
+ * Folders are stored as prefixes, with their trailing separator: the path of a file is its folder and name joined as they are.
+ */
+class PathArena {
+public:
+    using Folder = uint32_t;
+
+    // Add a folder, e.g. "in/sub/" or "" for the current directory. Folders are not looked up: each call adds one.
+    Folder addFolder(std::string_view prefix);
+    void add(Folder folder, std::string_view name);
+    // Add a path as it is, split at its last separator. Consecutive paths in the same folder share it.
+    void addPath(std::string_view path);
+
+    [[nodiscard]] size_t size() const { return files_.size(); }
+    [[nodiscard]] bool empty() const { return files_.empty(); }
+    [[nodiscard]] std::string_view folder(size_t index) const;
+    [[nodiscard]] std::string_view name(size_t index) const;
+    [[nodiscard]] std::string path(size_t index) const;
+    // Into a buffer of the caller, which can be reused to keep from allocating per file.
+    void path(size_t index, std::string& out) const;
+
+    // Order the files by folder, then by name.
+    void sort();
+    // Reorder the first order.size() files: the file at i becomes the one that was at order[i].
+    void permute(const std::vector<size_t>& order);
+
+private:
+    struct Slice {
+        uint64_t offset; // into chars_.
+        uint32_t size;
+    };
+    struct File {
+        uint64_t nameOffset; // into chars_.
+        Folder folder;
+        uint32_t nameSize;
+    };
+
+    std::vector<char> chars_; // the names of files and folders, back to back, without separators.
+    std::vector<Slice> folders_;
+    std::vector<File> files_;
+
+    [[nodiscard]] std::string_view view(uint64_t offset, uint32_t size) const { return {chars_.data() + offset, size}; }
+    uint64_t append(std::string_view s);
+};
+
+#endif //SPRITESHEETSPLITTER_PATHARENA_HPP
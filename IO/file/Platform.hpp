@@ -0,0 +1,18 @@
+#ifndef SPRITESHEETSPLITTER_PLATFORM_HPP
+#define SPRITESHEETSPLITTER_PLATFORM_HPP
+
+/**
+ * Which system calls the file layer (IO/file) is built on.
+ *
+ * On Linux, SPLITTER_LINUX_IO is defined, and files are mapped, created with openat, folders read with getdents64, and
+ * the kernel is told what is read next (posix_fadvise) and where files are on disk (FIEMAP). Everywhere else, e.g. on
+ * Windows, the same work is done with std::filesystem and stdio: a call per file, and without the hints.
+ *
+ * Building with SPLITTER_PORTABLE_IO (see CMakeLists.txt) uses the portable code on Linux too, so that it can be tested there.
+ * io_uring is detected separately, by CMake: SPLITTER_IO_URING is defined where the kernel headers have what UringWriter needs.
+ */
+#if defined(__linux__) && !defined(SPLITTER_PORTABLE_IO)
+#define SPLITTER_LINUX_IO
+#endif
+
+#endif //SPRITESHEETSPLITTER_PLATFORM_HPP
@@ -0,0 +1,97 @@
+#include "Prefetcher.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#if defined(SPLITTER_LINUX_IO)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Prefetcher::Prefetcher(const PathArena& files, size_t count, unsigned int ahead)
+    : files_(files), count_(std::min(count, files.size())), ahead_(ahead), budget_(availableBudget()) {
+#if defined(SPLITTER_LINUX_IO)
+    thread_ = std::thread(&Prefetcher::run, this);
+#endif
+}
+
+Prefetcher::~Prefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    progress_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void Prefetcher::started(size_t index) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index < started_) return;
+        started_ = index + 1;
+    }
+    progress_.notify_all();
+}
+
+#if defined(SPLITTER_LINUX_IO)
+/**
+ * Files are advised in order. A file the workers reached before it was advised is skipped: it is being read already.
+ * The size of a file is only known once it is opened, so a file that does not fit the budget yet is held open until it does.
+ */
+void Prefetcher::run() {
+    std::deque<std::pair<size_t, size_t>> advised; // index and size of the files advised and not started yet.
+    size_t advisedBytes = 0;
+    std::string path;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto forgetStarted = [&] {
+        while (!advised.empty() && advised.front().first < started_) {
+            advisedBytes -= advised.front().second;
+            advised.pop_front();
+        }
+    };
+
+    for (size_t next = 0; next < count_ && !stopping_;) {
+        progress_.wait(lock, [&] { return stopping_ || next < started_ + ahead_; });
+        if (stopping_) break;
+        next = std::max(next, started_);
+        if (next >= count_) break;
+
+        lock.unlock();
+        files_.path(next, path);
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st {};
+        const size_t size = fd >= 0 && fstat(fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+        lock.lock();
+
+        forgetStarted();
+        progress_.wait(lock, [&] {
+            forgetStarted();
+            return stopping_ || advised.empty() || advisedBytes + size <= budget_;
+        });
+        const bool worthIt = fd >= 0 && !stopping_ && next >= started_;
+        if (worthIt) {
+            advised.emplace_back(next, size);
+            advisedBytes += size;
+        }
+        lock.unlock();
+        if (worthIt) posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED); // only advice: failing changes nothing.
+        if (fd >= 0) ::close(fd);
+        lock.lock();
+        ++next;
+    }
+}
+#endif
+
+// static
+size_t Prefetcher::availableBudget() {
+#if !defined(SPLITTER_LINUX_IO)
+    return MAX_BUDGET;
+#else
+    const long pages = sysconf(_SC_AVPHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages <= 0 || pageSize <= 0) return MAX_BUDGET;
+    return std::min(static_cast<size_t>(pages) * static_cast<size_t>(pageSize) / 8, MAX_BUDGET);
+#endif
+}
@@ -0,0 +1,52 @@
+#ifndef SPRITESHEETSPLITTER_PREFETCHER_HPP
+#define SPRITESHEETSPLITTER_PREFETCHER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include "PathArena.hpp"
+#include "Platform.hpp"
+
+/**
+ * Asks the kernel to read the next files of a list into the page cache while the current ones are being worked on,
+ * so that loading a file finds it cached instead of waiting on the disk. Matters most on spinning disks and network mounts.
+ *
+ * A thread of its own keeps up to `ahead` files past the last one started advised with posix_fadvise(WILLNEED), which starts
+ * the reads and returns. The files advised but not yet started stay within a memory budget, so that they are not evicted
+ * again before they are used: an eighth of the available memory, at most MAX_BUDGET. At least one file is always advised.
+ *
+ * Only with SPLITTER_LINUX_IO (see Platform.hpp): elsewhere, there is no thread, and nothing is read ahead.
+ */
+class Prefetcher {
+public:
+    static constexpr size_t MAX_BUDGET = 256 * 1024 * 1024;
+
+    // files[0, count) are worked on, roughly in order.
+    Prefetcher(const PathArena& files, size_t count, unsigned int ahead);
+    // Stops advising. Reads already started go on.
+    ~Prefetcher();
+    Prefetcher(const Prefetcher&) = delete;
+    Prefetcher& operator=(const Prefetcher&) = delete;
+
+    // A worker started on files[index]. Thread safe.
+    void started(size_t index);
+
+private:
+    const PathArena& files_;
+    const size_t count_;
+    const unsigned int ahead_;
+    const size_t budget_;
+    std::mutex mutex_;
+    std::condition_variable progress_;
+    size_t started_ = 0; // files up to here are being or were worked on.
+    bool stopping_ = false;
+    std::thread thread_;
+
+#if defined(SPLITTER_LINUX_IO)
+    void run();
+#endif
+    static size_t availableBudget();
+};
+
+#endif //SPRITESHEETSPLITTER_PREFETCHER_HPP
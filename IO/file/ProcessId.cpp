@@ -0,0 +1,34 @@
+#include "ProcessId.hpp"
+
+#if defined(_WIN32)
+#include <process.h>
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#endif
+
+// static
+unsigned long ProcessId::current() {
+#if defined(_WIN32)
+    return static_cast<unsigned long>(_getpid());
+#else
+    return static_cast<unsigned long>(getpid());
+#endif
+}
+
+// static
+bool ProcessId::running(unsigned long id) {
+#if defined(_WIN32)
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(id));
+    if (!process) return GetLastError() == ERROR_ACCESS_DENIED; // someone else's.
+    DWORD exitCode = 0;
+    const bool running = GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE;
+    CloseHandle(process);
+    return running;
+#else
+    // signal 0 only checks whether the process could be signalled. EPERM: it runs, as another user.
+    return kill(static_cast<pid_t>(id), 0) == 0 || errno == EPERM;
+#endif
+}
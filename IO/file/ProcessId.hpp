@@ -0,0 +1,15 @@
+#ifndef SPRITESHEETSPLITTER_PROCESSID_HPP
+#define SPRITESHEETSPLITTER_PROCESSID_HPP
+
+/**
+ * The id of this process, for names that have to be unique between runs sharing an output directory,
+ * and whether the process behind such a name still runs.
+ */
+class ProcessId {
+public:
+    static unsigned long current();
+    // Whether a process with this id runs. An id can be reused: a process that is gone may seem to run on.
+    static bool running(unsigned long id);
+};
+
+#endif //SPRITESHEETSPLITTER_PROCESSID_HPP
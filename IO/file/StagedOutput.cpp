@@ -0,0 +1,138 @@
+#include "StagedOutput.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include "ProcessId.hpp"
+#if defined(SPLITTER_LINUX_IO)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+/**
+ * The staging folder is named after its folder, the process id and its number in the job: unique within the job,
+ * and never the name of a folder an interrupted run left behind. See abandoned for how the name is read back.
+ */
+StagedOutput::Stage* StagedOutput::stage(const std::string& folderName, std::error_code& ec) {
+    const fs::path stagingFolder = outDirectory_ / FOLDER_NAME;
+    std::lock_guard<std::mutex> lock(mutex_);
+    const fs::path staged = stagingFolder / (folderName + '_' + std::to_string(ProcessId::current()) + '_' + std::to_string(stages_.size()));
+
+    // another run removes the staging folder when it finds it empty, which can be right after it was created here.
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        fs::create_directory(stagingFolder, ec);
+        if (!ec) fs::create_directory(staged, ec);
+        if (ec != std::errc::no_such_file_or_directory) break;
+    }
+    if (ec) return nullptr;
+    stages_.push_back({staged, outDirectory_ / folderName});
+    return &stages_.back();
+}
+
+// static
+bool StagedOutput::abandoned(const std::string& name) {
+    const size_t number = name.rfind('_');
+    const size_t pid = number == std::string::npos || number == 0 ? std::string::npos : name.rfind('_', number - 1);
+    if (pid == std::string::npos) return true; // not a stage: nobody uses it.
+
+    unsigned long id = 0;
+    const char* first = name.data() + pid + 1;
+    const char* last = name.data() + number;
+    if (std::from_chars(first, last, id).ptr != last) return true;
+    return id == ProcessId::current() || !ProcessId::running(id);
+}
+
+void StagedOutput::seal(Stage* stage, unsigned int spriteCount) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stage->spriteCount = spriteCount;
+    stage->sealed = true;
+}
+
+void StagedOutput::failed(const std::string& staged, unsigned int count) {
+    const fs::path path(staged);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Stage& stage : stages_) {
+        if (stage.staged == path) stage.failedCount += count;
+    }
+}
+
+/**
+ * Stages are swapped in in the order they were staged: of two sheets with the same folder, the later one wins, as it did
+ * when each sheet emptied and refilled its folder. A stage with files that failed is not swapped in, and neither is any
+ * stage if the files cannot be synced: their sprites are lost. The output directory is synced once more at the end, for the renames.
+ */
+unsigned int StagedOutput::commit(std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stages_.empty()) return 0;
+
+#if defined(SPLITTER_LINUX_IO)
+    const int directory = ::open(outDirectory_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    const int syncError = directory < 0 || syncfs(directory) != 0 ? errno : 0;
+#else
+    const int syncError = 0;
+#endif
+
+    unsigned int lost = 0;
+    for (const Stage& stage : stages_) {
+        std::error_code ec;
+        if (!stage.sealed) {
+            reaper_.discard(stage.staged, outDirectory_, ec);
+            continue;
+        }
+        // a folder that is missing files is not swapped in: the complete folder of an earlier run stays.
+        if (stage.failedCount) {
+            if (lost == 0) error = stage.folder.string() + ": " + std::to_string(stage.failedCount) + " of its files could not be written";
+            lost += stage.spriteCount - std::min(stage.failedCount, stage.spriteCount);
+            reaper_.discard(stage.staged, outDirectory_, ec);
+            continue;
+        }
+        // nor are files that may not be on disk.
+        if (syncError) ec.assign(syncError, std::generic_category());
+        if (syncError || !swap(stage, ec)) {
+            if (lost == 0) error = stage.folder.string() + ": " + (syncError ? "cannot sync the output: " : "") + ec.message();
+            lost += stage.spriteCount;
+            reaper_.discard(stage.staged, outDirectory_, ec);
+        }
+    }
+    stages_.clear();
+
+#if defined(SPLITTER_LINUX_IO)
+    if (directory >= 0) {
+        fsync(directory);
+        ::close(directory);
+    }
+#endif
+    std::error_code ec;
+    fs::remove(outDirectory_ / FOLDER_NAME, ec); // only if empty: another run may be using it.
+    return lost;
+}
+
+/**
+ * Replace the folder of a stage with the staged folder. If the filesystem cannot exchange two names in one rename,
+ * or the system cannot (RENAME_EXCHANGE is Linux only), the old folder is moved out of the way first, and there is a moment without either.
+ */
+bool StagedOutput::swap(const Stage& stage, std::error_code& ec) {
+    if (!fs::exists(stage.folder, ec)) {
+        if (ec) return false;
+        fs::rename(stage.staged, stage.folder, ec);
+        return !ec;
+    }
+
+#if defined(SPLITTER_LINUX_IO)
+    if (renameat2(AT_FDCWD, stage.staged.c_str(), AT_FDCWD, stage.folder.c_str(), RENAME_EXCHANGE) == 0) {
+        reaper_.discard(stage.staged, outDirectory_, ec); // now the old folder.
+        ec.clear(); // the new folder is in place, whatever happens to the old one.
+        return true;
+    }
+    if (errno != EINVAL) {
+        ec.assign(errno, std::generic_category());
+        return false;
+    }
+#endif
+    if (!reaper_.discard(stage.folder, outDirectory_, ec)) return false;
+    fs::rename(stage.staged, stage.folder, ec);
+    return !ec;
+}
@@ -0,0 +1,70 @@
+#ifndef SPRITESHEETSPLITTER_STAGEDOUTPUT_HPP
+#define SPRITESHEETSPLITTER_STAGEDOUTPUT_HPP
+
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include "Platform.hpp"
+#include "TrashReaper.hpp"
+
+/**
+ * The output folders of a job, written where nobody looks and swapped in when complete: a folder in the output directory
+ * is either the one of an earlier run, or the complete one of this run, never something in between.
+ *
+ * Each folder is written into a staging folder, in FOLDER_NAME in the output directory. On commit, after all files are
+ * written, one syncfs makes all of them durable at once, instead of a sync per file or folder. Then every staged folder
+ * is swapped with the folder it replaces in one atomic rename (RENAME_EXCHANGE). The replaced folder goes to the TrashReaper.
+ * Both are Linux only (see Platform.hpp). Elsewhere, the files are not synced, and the old folder is moved to the trash
+ * right before the staged folder is renamed into its place: there is a moment without either.
+ *
+ * A run that is interrupted leaves its staging folders behind, which a later run deletes, once the process that staged
+ * them is gone: runs with the same output directory at the same time leave each other's stages alone. Folders named
+ * FOLDER_NAME are not searched for input sheets.
+ */
+class StagedOutput {
+public:
+    static constexpr const char* FOLDER_NAME = ".splitter-staging";
+
+    struct Stage {
+        std::filesystem::path staged; // where the files go.
+        std::filesystem::path folder; // what it replaces on commit.
+        unsigned int spriteCount = 0;
+        unsigned int failedCount = 0; // files that could not be written.
+        bool sealed = false;
+    };
+
+    StagedOutput(std::filesystem::path outDirectory, TrashReaper& reaper) : outDirectory_(std::move(outDirectory)), reaper_(reaper) {}
+
+    /**
+     * Create an empty staging folder for the folder outDirectory/folderName. Thread safe.
+     * @return the stage, or nullptr with ec set if the staging folder cannot be created.
+     */
+    Stage* stage(const std::string& folderName, std::error_code& ec);
+    // Every file of a stage was handed over: it replaces its folder on commit. Stages that are not sealed are deleted instead.
+    void seal(Stage* stage, unsigned int spriteCount);
+    // count files of the stage with this staging folder could not be written: it is deleted on commit, instead of swapped in. Thread safe.
+    void failed(const std::string& staged, unsigned int count);
+    /**
+     * Whether the staging folder with this name was left by a run that is gone: one of another process that no longer runs,
+     * or one of this process, which has no stages of its own between jobs. For TrashReaper::reapLeftovers.
+     */
+    static bool abandoned(const std::string& name);
+    /**
+     * Swap in the sealed stages, once every file in them is written.
+     * @return the number of sprites in stages that could not be swapped in, with the reason for the first in error.
+     * The files that failed are not counted: they were never written.
+     */
+    unsigned int commit(std::string& error);
+
+private:
+    std::filesystem::path outDirectory_;
+    TrashReaper& reaper_;
+    std::mutex mutex_;
+    std::deque<Stage> stages_; // a deque: the stages handed out stay where they are.
+
+    bool swap(const Stage& stage, std::error_code& ec);
+};
+
+#endif //SPRITESHEETSPLITTER_STAGEDOUTPUT_HPP
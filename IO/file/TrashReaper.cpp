@@ -0,0 +1,81 @@
+#include "TrashReaper.hpp"
+
+#include <ctime>
+#include "Platform.hpp"
+#include "ProcessId.hpp"
+#if defined(SPLITTER_LINUX_IO)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+TrashReaper::~TrashReaper() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    workAvailable_.notify_all();
+    if (thread_.joinable()) thread_.join();
+
+    std::error_code ec;
+    for (const fs::path& trashFolder : trashFolders_) fs::remove(trashFolder, ec); // only if empty: another run may be using it.
+}
+
+/**
+ * The name in the trash is made unique by the time, the process id and a counter: folders left by an earlier run,
+ * or by another run with the same output directory, are never renamed over.
+ */
+bool TrashReaper::discard(const fs::path& folder, const fs::path& directory, std::error_code& ec) {
+    const fs::path trashFolder = directory / FOLDER_NAME;
+    const fs::path trashName = trashFolder / (std::to_string(std::time(nullptr)) + '_' + std::to_string(ProcessId::current()) + '_' + std::to_string(counter_++));
+
+    fs::create_directory(trashFolder, ec);
+    if (!ec) fs::rename(folder, trashName, ec);
+    if (ec) { // e.g. a read-only parent, or a folder that is a mount point of its own.
+        ec.clear();
+        fs::remove_all(folder, ec);
+        return !ec;
+    }
+    reap(trashName, trashFolder);
+    return true;
+}
+
+void TrashReaper::reapLeftovers(const fs::path& folder, bool (*abandoned)(const std::string& name)) {
+    std::error_code ec;
+    for (const fs::directory_entry& entry : fs::directory_iterator(folder, ec)) {
+        if (abandoned && !abandoned(entry.path().filename().string())) continue;
+        reap(entry.path(), folder);
+    }
+}
+
+void TrashReaper::reap(fs::path path, const fs::path& trashFolder) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(path));
+    trashFolders_.insert(trashFolder);
+    if (!thread_.joinable()) thread_ = std::thread(&TrashReaper::run, this);
+    workAvailable_.notify_one();
+}
+
+/**
+ * Deleting is not urgent: on Linux, where the nice value is per thread, the thread runs at a lower priority than the
+ * splitting threads. What cannot be deleted stays in the trash, for the next run to try again.
+ */
+void TrashReaper::run() {
+#if defined(SPLITTER_LINUX_IO)
+    setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), 10);
+#endif
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        workAvailable_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) return; // stopping, and nothing left.
+
+        const fs::path path = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        std::error_code ec;
+        fs::remove_all(path, ec);
+        lock.lock();
+    }
+}
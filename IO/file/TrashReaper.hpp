@@ -0,0 +1,54 @@
+#ifndef SPRITESHEETSPLITTER_TRASHREAPER_HPP
+#define SPRITESHEETSPLITTER_TRASHREAPER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <system_error>
+#include <thread>
+
+/**
+ * Deletes old output folders in the background. A folder is renamed into a trash folder next to it, which is atomic and
+ * takes as long for a thousand files as for one, and is then deleted by a thread of its own while splitting goes on.
+ *
+ * Trash left behind by a run that was interrupted is picked up by reapLeftovers, when the next run starts.
+ * Folders named FOLDER_NAME are not searched for input sheets.
+ */
+class TrashReaper {
+public:
+    static constexpr const char* FOLDER_NAME = ".splitter-trash";
+
+    TrashReaper() = default;
+    // Waits until everything handed over is deleted.
+    ~TrashReaper();
+    TrashReaper(const TrashReaper&) = delete;
+    TrashReaper& operator=(const TrashReaper&) = delete;
+
+    /**
+     * Move folder into the trash folder in directory, to be deleted in the background. Thread safe.
+     * If it cannot be moved, e.g. because the trash folder cannot be created, it is deleted right away instead.
+     * @param directory on the same filesystem as folder, e.g. the output directory.
+     * @return false, with ec set, if the folder could be neither moved nor deleted.
+     */
+    bool discard(const std::filesystem::path& folder, const std::filesystem::path& directory, std::error_code& ec);
+    // Delete, in the background, what an earlier run left in folder: a trash or staging folder. With abandoned, only the entries it names.
+    void reapLeftovers(const std::filesystem::path& folder, bool (*abandoned)(const std::string& name) = nullptr);
+
+private:
+    std::mutex mutex_;
+    std::condition_variable workAvailable_;
+    std::deque<std::filesystem::path> queue_;
+    std::set<std::filesystem::path> trashFolders_; // removed themselves at the end, once empty.
+    std::thread thread_; // started with the first folder to delete.
+    bool stopping_ = false;
+    std::atomic<unsigned int> counter_ = 0; // for unique names in the trash.
+
+    void reap(std::filesystem::path path, const std::filesystem::path& trashFolder);
+    void run();
+};
+
+#endif //SPRITESHEETSPLITTER_TRASHREAPER_HPP
@@ -0,0 +1,290 @@
+#include "UringWriter.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr unsigned int CHAIN_LENGTH = 3; // openat, write, close.
+constexpr unsigned int SUBMISSION_ENTRIES = 256; // at least SLOTS * CHAIN_LENGTH, a power of two.
+constexpr unsigned int PROBE_OPS = 256;
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ring, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int ring, unsigned opcode, void* arg, unsigned nrArgs) {
+    return static_cast<int>(syscall(__NR_io_uring_register, ring, opcode, arg, nrArgs));
+}
+
+} // namespace
+
+static_assert(SUBMISSION_ENTRIES >= UringWriter::SLOTS * CHAIN_LENGTH);
+
+// static
+std::unique_ptr<UringWriter> UringWriter::create(std::string& error) {
+    std::unique_ptr<UringWriter> writer(new UringWriter());
+    if (!writer->setUp(error)) return nullptr;
+    writer->thread_.emplace_back(&UringWriter::run, writer.get());
+    return writer;
+}
+
+UringWriter::~UringWriter() {
+    stop(thread_);
+    if (sqes_) munmap(sqes_, sqesSize_);
+    if (rings_) munmap(rings_, ringsSize_);
+    if (ring_ >= 0) ::close(ring_);
+}
+
+/**
+ * Create the ring and map it, check that the kernel knows the operations of a chain, and register an empty file table
+ * with a slot per file in flight.
+ */
+bool UringWriter::setUp(std::string& error) {
+    io_uring_params params {};
+    ring_ = ioUringSetup(SUBMISSION_ENTRIES, &params);
+    if (ring_ < 0) {
+        error = std::string("io_uring_setup: ") + std::strerror(errno);
+        return false;
+    }
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        error = "io_uring without IORING_FEAT_SINGLE_MMAP";
+        return false;
+    }
+
+    ringsSize_ = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned), params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    void* rings = mmap(nullptr, ringsSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_, IORING_OFF_SQ_RING);
+    if (rings == MAP_FAILED) {
+        error = std::string("mmap of the io_uring rings: ") + std::strerror(errno);
+        return false;
+    }
+    rings_ = rings;
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        error = std::string("mmap of the io_uring submission entries: ") + std::strerror(errno);
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    auto* base = static_cast<unsigned char*>(rings_);
+    sqHead_ = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+    sqArray_ = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+    sqMask_ = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+    cqHead_ = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+    cqMask_ = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+
+    std::vector<unsigned char> probeBuffer(sizeof(io_uring_probe) + PROBE_OPS * sizeof(io_uring_probe_op), 0);
+    auto* probe = reinterpret_cast<io_uring_probe*>(probeBuffer.data());
+    if (ioUringRegister(ring_, IORING_REGISTER_PROBE, probe, PROBE_OPS) < 0) {
+        error = std::string("io_uring probe: ") + std::strerror(errno);
+        return false;
+    }
+    for (unsigned op : {IORING_OP_OPENAT, IORING_OP_WRITE, IORING_OP_CLOSE}) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            error = "io_uring without openat, write or close";
+            return false;
+        }
+    }
+
+    // a sparse table comes with Linux 5.19, later than opening into and closing a slot of the table (5.15).
+    io_uring_rsrc_register files {};
+    files.nr = SLOTS;
+    files.flags = IORING_RSRC_REGISTER_SPARSE;
+    if (ioUringRegister(ring_, IORING_REGISTER_FILES2, &files, sizeof(files)) < 0) {
+        error = std::string("io_uring file table: ") + std::strerror(errno);
+        return false;
+    }
+
+    slots_.resize(SLOTS);
+    for (unsigned int slot = SLOTS; slot-- > 0;) freeSlots_.push_back(slot);
+    return true;
+}
+
+/**
+ * Move queued files into free slots and their chains into the submission ring, then submit them and wait for at least
+ * one completion in a single io_uring_enter. Repeat until stopped with nothing queued or in flight.
+ *
+ * Should io_uring_enter fail for good, what is still in the ring is written with plain syscalls, and so is everything
+ * queued after, once the chains in flight completed.
+ */
+void UringWriter::run() {
+    unsigned int toSubmit = 0; // entries in the submission ring not yet taken by the kernel.
+    unsigned int inFlight = 0; // slots in use.
+    bool broken = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        if (inFlight == 0) {
+            workAvailable_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return; // stopping, and nothing left.
+        }
+        while (!queue_.empty() && !freeSlots_.empty()) {
+            Request request = std::move(queue_.front());
+            queue_.pop_front();
+            if (broken) {
+                lock.unlock();
+                const int error = writeFile(request);
+                lock.lock();
+                complete(request, error);
+                continue;
+            }
+            const unsigned int slot = freeSlots_.back();
+            freeSlots_.pop_back();
+            slots_[slot] = Slot {std::move(request)};
+            toSubmit += prepare(slot);
+            ++inFlight;
+        }
+        lock.unlock();
+
+        if (broken) {
+            // without io_uring_enter, completions still show up in the ring, as the kernel finishes the chains.
+            if (inFlight > 0) {
+                inFlight -= reap();
+                if (inFlight > 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        } else if (inFlight > 0) {
+            const int submitted = ioUringEnter(ring_, toSubmit, 1, IORING_ENTER_GETEVENTS);
+            if (submitted >= 0) {
+                toSubmit -= static_cast<unsigned int>(submitted);
+            } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                inFlight -= abandonUnsubmitted();
+                toSubmit = 0;
+                broken = true;
+            }
+            inFlight -= reap();
+        }
+        lock.lock();
+    }
+}
+
+unsigned int UringWriter::prepare(unsigned int slot) {
+    const Request& request = slots_[slot].request;
+    unsigned tail = *sqTail_;
+
+    auto next = [&](Op op) {
+        const unsigned index = tail++ & sqMask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->user_data = (static_cast<uint64_t>(slot) << 2u) | op;
+        sqArray_[index] = index;
+        return sqe;
+    };
+
+    // the write only runs if the open succeeded. The close runs whatever the write did (a hard link), to free the slot.
+    io_uring_sqe* open = next(OPEN);
+    open->opcode = IORING_OP_OPENAT;
+    open->fd = request.folder->fd();
+    open->addr = reinterpret_cast<uint64_t>(request.name);
+    open->len = 0666; // the mode, as in FileWriter::writeFile.
+    open->open_flags = O_WRONLY | O_CREAT | O_TRUNC; // O_CLOEXEC is implied for, and refused with, a slot of the table.
+    open->file_index = slot + 1;
+    open->flags = IOSQE_IO_LINK;
+
+    io_uring_sqe* write = next(WRITE);
+    write->opcode = IORING_OP_WRITE;
+    write->fd = static_cast<int>(slot);
+    write->addr = reinterpret_cast<uint64_t>(request.data.data());
+    write->len = static_cast<uint32_t>(std::min<size_t>(request.data.size(), UINT32_MAX));
+    write->off = 0;
+    write->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+
+    io_uring_sqe* close = next(CLOSE);
+    close->opcode = IORING_OP_CLOSE;
+    close->file_index = slot + 1;
+
+    __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+    return CHAIN_LENGTH;
+}
+
+unsigned int UringWriter::reap() {
+    std::vector<unsigned int> finished;
+    unsigned head = *cqHead_;
+    const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        const io_uring_cqe& cqe = cqes_[head & cqMask_];
+        const auto slot = static_cast<unsigned int>(cqe.user_data >> 2u);
+        Slot& s = slots_[slot];
+        switch (static_cast<Op>(cqe.user_data & 3u)) {
+            case OPEN:
+                s.openResult = cqe.res;
+                break;
+            case WRITE:
+                s.writeResult = cqe.res;
+                break;
+            case CLOSE:
+                s.closeResult = cqe.res;
+                break;
+        }
+        if (++s.completions == CHAIN_LENGTH) finished.push_back(slot);
+    }
+    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+
+    for (unsigned int slot : finished) finish(slot);
+    return finished.size();
+}
+
+/**
+ * A chain the kernel never ran (cancelled) or whose write did not write everything is written again with plain syscalls,
+ * which also gives the errno to report for it.
+ */
+void UringWriter::finish(unsigned int slot) {
+    Slot& s = slots_[slot];
+    int error = 0;
+    if (s.openResult == -ECANCELED || (s.openResult >= 0 && static_cast<size_t>(s.writeResult) != s.request.data.size())) {
+        error = writeFile(s.request);
+    } else if (s.openResult < 0) {
+        error = -s.openResult;
+    } else if (s.closeResult < 0 && s.closeResult != -ECANCELED) {
+        error = -s.closeResult;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        complete(s.request, error);
+    }
+    freeSlots_.push_back(slot);
+}
+
+/**
+ * Without SQPOLL, the kernel only reads the submission ring in io_uring_enter: moving the tail back to the head
+ * takes back what it did not read yet. Those entries count as cancelled. Returns the number of slots that got free.
+ */
+unsigned int UringWriter::abandonUnsubmitted() {
+    std::vector<unsigned int> finished;
+    const unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    for (unsigned i = head; i != *sqTail_; ++i) {
+        const io_uring_sqe& sqe = sqes_[sqArray_[i & sqMask_]];
+        const auto slot = static_cast<unsigned int>(sqe.user_data >> 2u);
+        Slot& s = slots_[slot];
+        switch (static_cast<Op>(sqe.user_data & 3u)) {
+            case OPEN:
+                s.openResult = -ECANCELED;
+                break;
+            case WRITE:
+                s.writeResult = -ECANCELED;
+                break;
+            case CLOSE:
+                s.closeResult = -ECANCELED;
+                break;
+        }
+        if (++s.completions == CHAIN_LENGTH) finished.push_back(slot);
+    }
+    __atomic_store_n(sqTail_, head, __ATOMIC_RELEASE);
+
+    for (unsigned int slot : finished) finish(slot);
+    return finished.size();
+}
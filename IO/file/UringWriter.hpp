@@ -0,0 +1,80 @@
+#ifndef SPRITESHEETSPLITTER_URINGWRITER_HPP
+#define SPRITESHEETSPLITTER_URINGWRITER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FileWriter.hpp"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/**
+ * Writes files through io_uring, from one thread: each file is a linked chain of openat, write and close that goes to the
+ * kernel with the chains of up to SLOTS other files in a single io_uring_enter, instead of three syscalls per file.
+ * The openat puts the file into a slot of a registered (fixed) file table, which the write and close refer to,
+ * so no file descriptor is ever handed back to user space.
+ *
+ * Uses the raw syscalls: liburing is not a dependency of this project. Needs Linux 5.19 or later (a sparse file table).
+ * A write that fails or comes up short in the ring is tried again with plain syscalls, whose error is the one reported.
+ */
+class UringWriter : public FileWriter {
+public:
+    static constexpr unsigned int SLOTS = 64; // files in flight.
+
+    // A writer, or nullptr with the reason in error if io_uring, or an operation it needs, is unavailable.
+    static std::unique_ptr<UringWriter> create(std::string& error);
+
+    ~UringWriter() override;
+    [[nodiscard]] WriteBackend backend() const override { return WriteBackend::URING; }
+
+private:
+    enum Op : uint64_t {
+        OPEN = 0,
+        WRITE = 1,
+        CLOSE = 2,
+    };
+
+    struct Slot {
+        Request request;
+        int openResult = 0;
+        int writeResult = 0;
+        int closeResult = 0;
+        unsigned int completions = 0; // one per op of the chain.
+    };
+
+    int ring_ = -1;
+    void* rings_ = nullptr; // the submission and completion rings, in one mapping.
+    size_t ringsSize_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqesSize_ = 0;
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned cqMask_ = 0;
+
+    std::vector<Slot> slots_;
+    std::vector<unsigned int> freeSlots_;
+    std::vector<std::thread> thread_;
+
+    UringWriter() = default;
+    bool setUp(std::string& error);
+    void run();
+    // Queue the chain of a slot in the submission ring. Returns the number of entries queued.
+    unsigned int prepare(unsigned int slot);
+    // Handle the completions in the ring. Returns the number of slots that got free.
+    unsigned int reap();
+    // Report the file of a slot whose chain completed, and free the slot.
+    void finish(unsigned int slot);
+    // Take back what is in the submission ring but not yet submitted, and write those files with plain syscalls instead.
+    // Returns the number of slots that got free.
+    unsigned int abandonUnsubmitted();
+};
+
+#endif //SPRITESHEETSPLITTER_URINGWRITER_HPP
@@ -0,0 +1,11 @@
+#include "ArchiveSink.hpp"
+
+unsigned int ArchiveSink::put(std::string_view name, const unsigned char*, unsigned int, unsigned int, std::vector<unsigned char>&& encoded) {
+    entries_.push_back({folder_ + std::string(name) + extension_, std::move(encoded)});
+    return 0;
+}
+
+unsigned int ArchiveSink::finish() {
+    // 79: lodepng's "failed to open file for writing", as lodepng::save_file would have reported for loose files.
+    return archive_.append(entries_) ? 0 : 79;
+}
@@ -0,0 +1,24 @@
+#ifndef SPRITESHEETSPLITTER_ARCHIVESINK_HPP
+#define SPRITESHEETSPLITTER_ARCHIVESINK_HPP
+
+#include "SpriteSink.hpp"
+#include "../archive/ArchiveWriter.hpp"
+
+// Collects the files of a sheet, and appends them to the archive of the job on finish, in one go.
+class ArchiveSink : public SpriteSink {
+public:
+    // folder: the path inside the archive the files go into, with a trailing '/', or empty.
+    ArchiveSink(ArchiveWriter& archive, std::string folder, std::string extension) : archive_(archive), folder_(std::move(folder)), extension_(std::move(extension)) {}
+
+    unsigned int put(std::string_view name, const unsigned char* rgba, unsigned int width, unsigned int height,
+                     std::vector<unsigned char>&& encoded) final;
+    unsigned int finish() final;
+
+private:
+    ArchiveWriter& archive_;
+    std::string folder_;
+    std::string extension_; // including the dot.
+    std::vector<ArchiveWriter::Entry> entries_;
+};
+
+#endif //SPRITESHEETSPLITTER_ARCHIVESINK_HPP
@@ -0,0 +1,13 @@
+#include "AtlasSink.hpp"
+
+unsigned int AtlasSink::put(std::string_view name, const unsigned char* rgba, unsigned int width, unsigned int height, std::vector<unsigned char>&&) {
+    // the pixels are a buffer the saver reuses for the next sprite.
+    sprites_.push_back({folder_ + std::string(name) + extension_, width, height, std::vector<unsigned char>(rgba, rgba + static_cast<size_t>(width) * height * 4)});
+    return 0;
+}
+
+unsigned int AtlasSink::finish() {
+    atlas_.append(std::move(sprites_));
+    sprites_.clear();
+    return 0;
+}
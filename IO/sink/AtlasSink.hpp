@@ -0,0 +1,25 @@
+#ifndef SPRITESHEETSPLITTER_ATLASSINK_HPP
+#define SPRITESHEETSPLITTER_ATLASSINK_HPP
+
+#include "SpriteSink.hpp"
+#include "../atlas/AtlasWriter.hpp"
+
+// Collects the pixels of a sheet's sprites, and hands them to the atlas of the job on finish. Nothing is encoded per sprite.
+class AtlasSink : public SpriteSink {
+public:
+    // folder: prefix of the sprite names in the atlas index, with a trailing '/', or empty.
+    AtlasSink(AtlasWriter& atlas, std::string folder, std::string extension) : atlas_(atlas), folder_(std::move(folder)), extension_(std::move(extension)) {}
+
+    unsigned int put(std::string_view name, const unsigned char* rgba, unsigned int width, unsigned int height,
+                     std::vector<unsigned char>&& encoded) final;
+    unsigned int finish() final;
+    [[nodiscard]] bool needsEncoding() const final { return false; }
+
+private:
+    AtlasWriter& atlas_;
+    std::string folder_;
+    std::string extension_; // including the dot.
+    std::vector<AtlasWriter::Sprite> sprites_;
+};
+
+#endif //SPRITESHEETSPLITTER_ATLASSINK_HPP
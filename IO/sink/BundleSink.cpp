@@ -0,0 +1,15 @@
+#include "BundleSink.hpp"
+
+unsigned int BundleSink::put(std::string_view name, const unsigned char* rgba, unsigned int width, unsigned int height, std::vector<unsigned char>&& encoded) {
+    if (payload_ == SpriteBundle::Payload::RGBA) {
+        writer_.add(name, width, height, rgba, static_cast<size_t>(width) * height * 4);
+    } else {
+        writer_.add(name, width, height, encoded.data(), encoded.size());
+    }
+    return 0;
+}
+
+unsigned int BundleSink::finish() {
+    // 79: lodepng's "failed to open file for writing", as lodepng::save_file would have reported for loose files.
+    return writer_.save(file_.string()) ? 0 : 79;
+}
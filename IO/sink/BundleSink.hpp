@@ -0,0 +1,24 @@
+#ifndef SPRITESHEETSPLITTER_BUNDLESINK_HPP
+#define SPRITESHEETSPLITTER_BUNDLESINK_HPP
+
+#include <filesystem>
+#include "SpriteSink.hpp"
+#include "../bundle/SpriteBundleWriter.hpp"
+
+// Collects the sprites of a sheet into one sprite bundle file (see IO/bundle/SpriteBundle.hpp), written on finish.
+class BundleSink : public SpriteSink {
+public:
+    BundleSink(std::filesystem::path file, SpriteBundle::Payload payload) : file_(std::move(file)), writer_(payload), payload_(payload) {}
+
+    unsigned int put(std::string_view name, const unsigned char* rgba, unsigned int width, unsigned int height,
+                     std::vector<unsigned char>&& encoded) final;
+    unsigned int finish() final;
+    [[nodiscard]] bool needsEncoding() const final { return payload_ != SpriteBundle::Payload::RGBA; }
+
+private:
+    std::filesystem::path file_;
+    SpriteBundleWriter writer_;
+    SpriteBundle::Payload payload_;
+};
+
+#endif //SPRITESHEETSPLITTER_BUNDLESINK_HPP
@@ -0,0 +1,20 @@
+#include "FileSink.hpp"
+
+/**
+ * The file is created by its bare name in the folder: no path is built, and the kernel only looks up the name.
+ * Like lodepng::save_file did before, existing files are overwritten without warning.
+ */
+unsigned int FileSink::put(std::string_view name, const unsigned char*, unsigned int, unsigned int, std::vector<unsigned char>&& encoded) {
+    // 79: lodepng's "failed to open file for writing", as lodepng::save_file reported it.
+    if (name.size() + extension_.size() > FileWriter::MAX_NAME) return 79;
+
+    char fileName[FileWriter::MAX_NAME + 1];
+    const size_t length = name.copy(fileName, name.size()) + extension_.copy(fileName + name.size(), extension_.size());
+    fileName[length] = '\0';
+
+    if (writer_) {
+        writer_->write(folder_, std::string_view(fileName, length), std::move(encoded));
+        return 0;
+    }
+    return FileWriter::writeFile(*folder_, fileName, encoded.data(), encoded.size()) ? 79 : 0;
+}
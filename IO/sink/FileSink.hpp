@@ -0,0 +1,27 @@
+#ifndef SPRITESHEETSPLITTER_FILESINK_HPP
+#define SPRITESHEETSPLITTER_FILESINK_HPP
+
+#include "SpriteSink.hpp"
+#include "../file/FileWriter.hpp"
+#include "../file/OutputFolder.hpp"
+
+/**
+ * Writes every sprite as a file of its own into a folder, opened once for all of them. The default output.
+ * With a writer, files are handed to it and written in the background; errors then show up in FileWriter::wait, not in put.
+ * Without one, each file is written in put.
+ */
+class FileSink : public SpriteSink {
+public:
+    FileSink(std::shared_ptr<const OutputFolder> folder, std::string extension, FileWriter* writer) : folder_(std::move(folder)), extension_(std::move(extension)), writer_(writer) {}
+
+    unsigned int put(std::string_view name, const unsigned char* rgba, unsigned int width, unsigned int height,
+                     std::vector<unsigned char>&& encoded) final;
+    unsigned int finish() final { return 0; }
+
+private:
+    std::shared_ptr<const OutputFolder> folder_;
+    std::string extension_; // including the dot.
+    FileWriter* writer_; // may be null.
+};
+
+#endif //SPRITESHEETSPLITTER_FILESINK_HPP
@@ -0,0 +1,38 @@
+#ifndef SPRITESHEETSPLITTER_SPRITENAME_HPP
+#define SPRITESHEETSPLITTER_SPRITENAME_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+/**
+ * The name of a sprite as handed to a SpriteSink, e.g. '0' or '3_Right_Walk_0', formatted into a buffer of its own:
+ * naming a sprite allocates nothing. The index is formatted once, the sprites of a character only swap the suffix.
+ */
+class SpriteName {
+public:
+    static constexpr size_t CAPACITY = 48; // an int, '_', and the longest suffix, with room to spare.
+
+    explicit SpriteName(int index) {
+        indexSize_ = size_ = static_cast<size_t>(std::to_chars(buffer_, buffer_ + CAPACITY, index).ptr - buffer_);
+    }
+
+    // The index, or the index, '_' and suffix. Suffixes that do not fit are cut off.
+    std::string_view view() const { return {buffer_, size_}; }
+    std::string_view withSuffix(std::string_view suffix) {
+        size_ = indexSize_;
+        buffer_[size_++] = '_';
+        const size_t length = std::min(suffix.size(), CAPACITY - size_);
+        std::memcpy(buffer_ + size_, suffix.data(), length);
+        size_ += length;
+        return view();
+    }
+
+private:
+    char buffer_[CAPACITY];
+    size_t indexSize_;
+    size_t size_;
+};
+
+#endif //SPRITESHEETSPLITTER_SPRITENAME_HPP
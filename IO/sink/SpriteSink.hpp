@@ -0,0 +1,31 @@
+#ifndef SPRITESHEETSPLITTER_SPRITESINK_HPP
+#define SPRITESHEETSPLITTER_SPRITESINK_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Where the saved sprites of one sheet go. SpriteSheetIO::saveSplits creates a sink per sheet,
+ * hands it every sprite that is not fully transparent, and finishes it after the last one.
+ */
+class SpriteSink {
+public:
+    virtual ~SpriteSink() = default;
+
+    /**
+     * @param name the file name the sprite has as loose file, without extension, e.g. '0' or '3_Right_Walk_0'.
+     * @param rgba the pixels of the sprite.
+     * @param encoded the sprite encoded in the output format. Empty for raw RGBA output, or if the sink does not need encoding.
+     *                The sink may take it over, to write it later.
+     * @return error code from lodePNG (0 = OK).
+     */
+    virtual unsigned int put(std::string_view name, const unsigned char* rgba, unsigned int width, unsigned int height,
+                             std::vector<unsigned char>&& encoded) = 0;
+    // Called once, after the last put. On error (lodePNG error code), every sprite put into this sink is lost.
+    virtual unsigned int finish() = 0;
+    // Whether put needs the encoded sprite. If not, the saver skips encoding: the sink only uses the pixels.
+    [[nodiscard]] virtual bool needsEncoding() const { return true; }
+};
+
+#endif //SPRITESHEETSPLITTER_SPRITESINK_HPP
@@ -2,12 +2,56 @@
 #include <syncstream>
 #include <omp.h>
 #include <functional>
+#include <chrono>
+#include <ctime>
 #include "Splitter.h"
+#include "IO/file/DiskOrder.hpp"
+#include "IO/file/Prefetcher.hpp"
 #include "util/SimpleTimer.h"
 #include "logging/LoggerTags.hpp"
 
 namespace logger = LoggerTags;
 
+namespace {
+// Rough cost model for planFolder, measured on one core with the lodepng deflate backend. Indexed by CompressionProfile.
+// CPU time per pixel of a sheet (decode, split, encode), and per sprite file written (filesystem calls, PNG headers).
+constexpr double PLAN_NS_PER_PIXEL[] = {265, 520, 835};
+constexpr double PLAN_NS_PER_FILE[] = {350e3, 360e3, 690e3};
+// Sprites compress about as well as their sheet does. Each file adds its PNG overhead (signature, IHDR, IDAT, IEND, zlib).
+constexpr double PLAN_BYTES_PER_FILE = 100;
+
+/**
+ * Time a thread spent waiting rather than running, e.g. on the disk while loading: the wall clock time that passed,
+ * less the CPU time the thread used in it. Where there is no per thread CPU clock (e.g. Windows), that is all the wall clock time.
+ */
+class BlockedClock {
+public:
+    BlockedClock() { restart(); }
+    void restart() {
+        wall_ = std::chrono::steady_clock::now();
+        cpu_ = threadCpuSeconds();
+    }
+    [[nodiscard]] double seconds() const {
+        const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_).count();
+        return std::max(0.0, wall - (threadCpuSeconds() - cpu_));
+    }
+
+private:
+    std::chrono::steady_clock::time_point wall_;
+    double cpu_;
+
+    static double threadCpuSeconds() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+        timespec ts {};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+#else
+        return 0;
+#endif
+    }
+};
+}
+
 void Splitter::work(std::vector <SplitterOpts> &jobs) {
     SpriteSplittingStatus jobStats;
 
@@ -27,62 +71,92 @@ void Splitter::work(std::vector <SplitterOpts> &jobs) {
             continue;
         }
 
-        std::queue<std::string> pngQueue;
-        ssio.fillPNGQueue(pngQueue);
+        PathArena pngs;
+        ssio.fillPNGList(pngs);
 
-        if (pngQueue.empty()) {
+        if (pngs.empty()) {
             std::cout << logger::error << "Zero '.png' files were found in input path:";
             std::cout << "\n\t\t" << job.inDirectory << "\n";
             std::cout << logger::error << "This job will be skipped.\n";
+            ssio.finishOutput(jobStats);
             continue;
         }
+        if (! job.isPNGInDirectory && job.readOrder != ReadOrder::PATH) {
+            orderForReading(pngs, job.workAmount, job.readOrder);
+        }
+
+        if (job.planOnly) {
+            std::cout << logger::info << "Begin planning \"" << job.inDirectory << "\" with " << job;
+
+            planFolder(job.isPNGInDirectory ? 1 : job.workAmount, pngs, job.compressionProfile);
+        } else if (job.recompress) {
+            std::cout << logger::info << "Begin recompressing \"" << job.inDirectory << "\" with " << job;
 
-        if (job.isPNGInDirectory) {
+            recompressFolder(job.isPNGInDirectory ? 1 : job.workAmount, pngs, jobStats);
+        } else if (job.isPNGInDirectory) {
             std::cout << logger::info << "Begin working on file \"" << job.inDirectory << "\"with " << job;
 
-            std::string& onlyFile = pngQueue.front();
-            split(onlyFile, jobStats, std::cout);
-            pngQueue.pop();
+            split(pngs.path(0), jobStats, std::cout);
         } else {
             std::cout << logger::info << "Begin working on folder \"" << job.inDirectory << "\" with " << job;
 
-            workFolder(job.workAmount, pngQueue, jobStats);
+            workFolder(job.workAmount, job.prefetch, pngs, jobStats);
         }
 
+        ssio.finishOutput(jobStats);
         std::cout << logger::info << "DONE with job " << ++jobCounter << " out of " << jobs.size() << "\n";
-
-        // assert PNG Queue is empty.
-        if (! pngQueue.empty()) {
-            throw std::logic_error("End of job reached but PNG queue not empty.");
-        }
     }
 
     std::cout << logger::info << "COMPLETED all pending jobs. " << jobStats;
 }
 
 /**
- * Split all PNGs of a folder by following the string filepaths in the pngs queue.
+ * Sort the PNGs that will be worked on by where they are on disk. With a workCap, these are the first by path,
+ * or the first listed when they come from a file list: the order decides how they are read, not which are. See DiskOrder.
+ *
+ * @param workCap the maximum amount of files that will be processed
+ * @param pngs the list of FilePaths to SpriteSheets, sorted by path, or in the order of the file list
+ * @param order INODE or EXTENT
+ */
+void Splitter::orderForReading(PathArena &pngs, int workCap, ReadOrder order) {
+    const size_t work = std::min(static_cast<size_t>(workCap), pngs.size());
+    const DiskOrder::Report report = DiskOrder::sort(pngs, work, order);
+
+    std::cout << logger::info << "Ordered " << report.sorted << " files by " << report.order << ".\n";
+    if (report.order != order) {
+        std::cout << logger::warn << "The filesystem cannot tell where the data of files is: ordered by inode instead.\n";
+    }
+    if (report.distanceKnown) {
+        constexpr double MIB = 1024.0 * 1024.0;
+        std::cout << logger::info << "Distance on disk between consecutive files, summed: " << static_cast<double>(report.distanceBefore) / MIB
+                  << " MiB by path, " << static_cast<double>(report.distanceAfter) / MIB << " MiB now.\n";
+    }
+}
+
+/**
+ * Split all PNGs of a folder by following the filepaths in the pngs list.
  *
- * This is done by assigning one thread per file for adequate performance
+ * This is done by assigning one thread per file for adequate performance.
+ * The path of a file is only put together by the thread that opens it.
+ * Meanwhile, a Prefetcher has the next files read into the page cache.
  *
  * @param workCap the maximum amount of files to process before stopping
- * @param pngs the queue of FilePaths to SpriteSheets
+ * @param prefetch the amount of files to have read ahead of the workers, 0 for none.
+ * @param pngs the list of FilePaths to SpriteSheets
  * @param jobStats stat tracking object
  */
-void Splitter::workFolder(int workCap, std::queue<std::string> &pngs, SpriteSplittingStatus &jobStats) {
+void Splitter::workFolder(int workCap, int prefetch, const PathArena &pngs, SpriteSplittingStatus &jobStats) {
     const int work = std::min(workCap, static_cast<int>(pngs.size()));
+    std::unique_ptr<Prefetcher> prefetcher;
+    if (prefetch > 0 && work > 1) prefetcher = std::make_unique<Prefetcher>(pngs, work, prefetch);
 
     SimpleTimer folder("Splitting this folder");
-#pragma omp parallel for schedule(dynamic) shared(work, pngs, std::cout, jobStats, logger::info) default(none)
+#pragma omp parallel for schedule(dynamic) shared(work, pngs, prefetcher, std::cout, jobStats, logger::info) default(none)
     for (int tid = 0; tid < work; ++tid) {
         if (tid == 0) std::cout << logger::info << " Begin working on a folder using " << omp_get_num_threads() << " threads\n";
 
-        std::string file;
-#pragma omp critical(queueAccess)
-        {
-            file = std::move(pngs.front());
-            pngs.pop();
-        }
+        if (prefetcher) prefetcher->started(tid);
+        const std::string file = pngs.path(tid);
 
         // for printing without data races. Downside, only prints when the object is destroyed (end of loop iteration).
         std::osyncstream synced_out(std::cout);
@@ -97,6 +171,106 @@ void Splitter::workFolder(int workCap, std::queue<std::string> &pngs, SpriteSpli
     }
 }
 
+/**
+ * Recompress all PNGs of a folder (and its subfolders) in place, by following the filepaths in the pngs list.
+ * This is the second pass of a fast write, e.g. with the 'stored' deflate backend. See SpriteSheetIO::recompressPNG.
+ *
+ * Like workFolder, this assigns one thread per file.
+ *
+ * @param workCap the maximum amount of files to process before stopping
+ * @param pngs the list of FilePaths to saved sprites
+ * @param jobStats stat tracking object
+ */
+void Splitter::recompressFolder(int workCap, const PathArena &pngs, SpriteSplittingStatus &jobStats) {
+    const int work = std::min(workCap, static_cast<int>(pngs.size()));
+
+    SimpleTimer folder("Recompressing this folder");
+#pragma omp parallel for schedule(dynamic) shared(work, pngs, std::cout, jobStats) default(none)
+    for (int tid = 0; tid < work; ++tid) {
+        const std::string file = pngs.path(tid);
+
+        std::osyncstream synced_out(std::cout);
+
+        SpriteSplittingStatus individualJobStats;
+        ssio.recompressPNG(file, individualJobStats, synced_out);
+
+#pragma omp critical(updateStats)
+        {
+            jobStats += individualJobStats;
+        }
+    }
+}
+
+/**
+ * Print what splitting the PNGs of a folder would do, without decoding or writing anything: only the PNG headers are read.
+ *
+ * Per sheet, prints the type it is detected as, the amount of tiles and the output folder,
+ * with an estimate of the output size and CPU time. Tiles that turn out fully transparent are not written,
+ * so the amount of tiles (and with it the estimates) is an upper bound. The estimates are only meant for sizing a run.
+ *
+ * @param workCap the maximum amount of files to plan before stopping
+ * @param pngs the list of FilePaths to SpriteSheets
+ * @param profile the CompressionProfile the sprites would be saved with.
+ */
+void Splitter::planFolder(int workCap, const PathArena &pngs, CompressionProfile profile) {
+    const int work = std::min(workCap, static_cast<int>(pngs.size()));
+    const auto profileIndex = static_cast<size_t>(profile);
+
+    unsigned int sheets = 0;
+    unsigned int rejected = 0;
+    uint64_t totalTiles = 0;
+    double totalBytes = 0;
+    double totalSeconds = 0;
+
+    SimpleTimer timer("Planning this folder");
+    for (int i = 0; i < work; ++i) {
+        const std::string file = pngs.path(i);
+        const std::string fileName = fs::path(file).filename().string();
+
+        SpriteSheetPNGData pngData;
+        SpriteSheetIO::loadPNGHeader(file, pngData);
+        if (pngData.error) {
+            std::cout << logger::error << fileName << ": LodePNG decode error: " << pngData.error << ". (Most likely a corrupt png)\n";
+            rejected++;
+            continue;
+        }
+
+        SpriteSheetType type;
+        if (! classifySheet(pngData.width, pngData.height, fileName, type)) {
+            std::cout << logger::warn << fileName << ": An image of size " << pngData.width << ", " << pngData.height << " is not a valid SpriteSheet. It would be skipped.\n";
+            rejected++;
+            continue;
+        }
+
+        // same sizes as split(): character sheets lose column 3, and join columns 5 and 6.
+        const unsigned int columns = type == SpriteSheetType::CHARACTER ? CHAR_SHEET_ROW : OBJ_SHEET_ROW;
+        const unsigned int spriteSize = pngData.width / columns;
+        const uint64_t rows = pngData.height / spriteSize;
+        const uint64_t tiles = rows * (type == SpriteSheetType::CHARACTER ? SPRITES_PER_CHAR : columns);
+
+        std::error_code ec;
+        const uintmax_t fileSize = fs::file_size(file, ec);
+        const double bytes = (ec ? 0.0 : static_cast<double>(fileSize)) + static_cast<double>(tiles) * PLAN_BYTES_PER_FILE;
+        const double seconds = (static_cast<double>(pngData.width) * pngData.height * PLAN_NS_PER_PIXEL[profileIndex]
+                                + static_cast<double>(tiles) * PLAN_NS_PER_FILE[profileIndex]) * 1e-9;
+
+        std::cout << logger::info << fileName << ": " << type << " sheet of " << pngData.width << "x" << pngData.height
+                  << ", up to " << tiles << " tiles of " << spriteSize << "x" << spriteSize
+                  << " into " << ssio.outputFolder(file, type).string()
+                  << " (~" << static_cast<uint64_t>(bytes / 1024) << " KiB, ~" << seconds << " s CPU)\n";
+
+        sheets++;
+        totalTiles += tiles;
+        totalBytes += bytes;
+        totalSeconds += seconds;
+    }
+
+    const int threads = omp_get_max_threads();
+    std::cout << logger::info << "Plan: " << sheets << " sheets, up to " << totalTiles << " tiles, " << rejected << " files skipped.\n";
+    std::cout << logger::info << "Estimated output: ~" << static_cast<uint64_t>(totalBytes / 1024) << " KiB, ~"
+              << totalSeconds << " s CPU (~" << totalSeconds / threads << " s on " << threads << " threads).\n";
+}
+
 /**
  * Load a SpriteSheet from the given fileDirectory, split the data in single sprites with the correct name, then save.
  *
@@ -117,7 +291,11 @@ void Splitter::split(const std::string &fileDirectory, SpriteSplittingStatus &jo
 
     outStream << logger::threaded_info << "Loading " << fileDirectory << "\n";
 
-    SpriteSheetIO::loadPNG(fileDirectory, img, pngData);
+    // The dimensions decide whether this is a SpriteSheet at all. Read them from the header first,
+    // so that other images in the folder (UI art, portraits..) are rejected without inflating their pixels.
+    BlockedClock loading;
+    SpriteSheetIO::loadPNGHeader(fileDirectory, pngData);
+    jobStats.load_seconds_blocked += loading.seconds();
 
     if (pngData.error) {
         outStream << logger::threaded_error << "LodePNG decode error: " << pngData.error << ". (Most likely a corrupt png)\n"; // if it's an incorrect path at this point then that is a bug!
@@ -126,17 +304,29 @@ void Splitter::split(const std::string &fileDirectory, SpriteSplittingStatus &jo
     }
 
     SpriteSheetType type;
-    if (validSpriteSheet(pngData.width, pngData.height, OBJ_SHEET_ROW)) {
-        // ground and object sheets are indistinguishable from dimensions alone.
-        // One must be assumed, and the other has to be deduced by some rules. e.g. configured pattern matching.
-        bool isGround = std::regex_search(fileName, ground_matcher);
-
-        type = isGround ? SpriteSheetType::GROUND :  SpriteSheetType::OBJECT;
-    } else if (validSpriteSheet(pngData.width, pngData.height, CHAR_SHEET_ROW)) {
-        type = SpriteSheetType::CHARACTER;
-    } else {
+    if (! classifySheet(pngData.width, pngData.height, fileName, type)) {
         outStream << logger::threaded_error << "An image of size " << pngData.width << ", " << pngData.height << " is not a valid SpriteSheet.\n";
         jobStats.n_load_error += 1;
+        jobStats.n_decode_avoided += 1;
+        return;
+    }
+
+    const unsigned int headerWidth = pngData.width;
+    const unsigned int headerHeight = pngData.height;
+    loading.restart();
+    SpriteSheetIO::loadPNG(fileDirectory, img, pngData);
+    jobStats.load_seconds_blocked += loading.seconds(); // the sheet is decoded from its mapping: this is the time spent on page faults.
+    jobStats.load_bytes += pngData.fileSize;
+
+    if (pngData.error) {
+        outStream << logger::threaded_error << "LodePNG decode error: " << pngData.error << ". (Most likely a corrupt png)\n";
+        jobStats.n_load_error += 1;
+        return;
+    }
+    // only possible if the file was replaced in between the two reads.
+    if (pngData.width != headerWidth || pngData.height != headerHeight) {
+        outStream << logger::threaded_error << "The file changed while loading it.\n";
+        jobStats.n_load_error += 1;
         return;
     }
 
@@ -254,6 +444,30 @@ void Splitter::splitCharSheet(SpriteSplittingData& ssd) {
     }
 }
 
+/**
+ * Detects the SpriteSheetType from the dimensions of an image, and for object sheets, the file name.
+ *
+ * @param width width of the png
+ * @param height height of the png
+ * @param fileName name of the png, matched against the ground pattern.
+ * @param type receives the detected type, if any.
+ * @return whether the image is a valid SpriteSheet of any type.
+ */
+bool Splitter::classifySheet(unsigned int width, unsigned int height, const std::string &fileName, SpriteSheetType &type) const {
+    if (validSpriteSheet(width, height, OBJ_SHEET_ROW)) {
+        // ground and object sheets are indistinguishable from dimensions alone.
+        // One must be assumed, and the other has to be deduced by some rules. e.g. configured pattern matching.
+        bool isGround = std::regex_search(fileName, ground_matcher);
+
+        type = isGround ? SpriteSheetType::GROUND :  SpriteSheetType::OBJECT;
+    } else if (validSpriteSheet(width, height, CHAR_SHEET_ROW)) {
+        type = SpriteSheetType::CHARACTER;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 /**
  * tests if the given image dimensions are that of a correctly formed SpriteSheetData.
  * A SpriteSheetData has equally sized columns (objects vs chars), where each column is at least 8px wide, and the column width is a power of 2.
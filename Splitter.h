@@ -15,8 +15,12 @@ private:
     SpriteSheetIO ssio;
     std::regex ground_matcher; // default initialized regexes match nothing, so we do not need to initialize this.
 
-    void workFolder(int workCap, std::queue<std::string> &pngs, SpriteSplittingStatus &jobStats);
+    void workFolder(int workCap, int prefetch, const PathArena &pngs, SpriteSplittingStatus &jobStats);
+    void recompressFolder(int workCap, const PathArena &pngs, SpriteSplittingStatus &jobStats);
+    void planFolder(int workCap, const PathArena &pngs, CompressionProfile profile);
+    static void orderForReading(PathArena &pngs, int workCap, ReadOrder order);
     void split(const std::string &fileDirectory, SpriteSplittingStatus &jobStats, std::basic_ostream<char> &outStream);
+    bool classifySheet(unsigned int width, unsigned int height, const std::string &fileName, SpriteSheetType &type) const;
     static bool validSpriteSheet(unsigned int width, unsigned int height, unsigned int columnCount);
     static void splitObjectSheet(SpriteSplittingData& ssd);
     static void splitCharSheet(SpriteSplittingData& ssd);
@@ -22,7 +22,7 @@ std::string& getHELP_STRING() {
 
 // used by getopt, getopt_long etc. each character is the short name of an option. Colon after means it has a parameter. Double colon means optional parameter.
 std::string& getOPT_STR() {
-    static std::string OPT_STR = "hrsda:i:u:o::g::k::c::";
+    static std::string OPT_STR = "hrsdxneblma:i:u:z:p:t:f:w:q:j:y:v:o::g::k::c::";
     return OPT_STR;
 }
 
@@ -48,6 +48,21 @@ int main(int argc, char* argv[]) {
             {"config",   optional_argument,  nullptr, 'c'},
             {"singleFolderOutput", no_argument, nullptr, 's'},
             {"subtractAlphaFromIndex", no_argument, nullptr, 'a'},
+            {"reduceColors", no_argument,       nullptr, 'x'},
+            {"plan",        no_argument,        nullptr, 'n'},
+            {"recompress",  no_argument,        nullptr, 'e'},
+            {"bundle",      no_argument,        nullptr, 'b'},
+            {"atlas",       no_argument,        nullptr, 'l'},
+            {"animate",     no_argument,        nullptr, 'm'},
+            {"deflate",     required_argument,  nullptr, 'z'},
+            {"profile",     required_argument,  nullptr, 'p'},
+            {"chunks",      required_argument,  nullptr, 't'},
+            {"format",      required_argument,  nullptr, 'f'},
+            {"archive",     required_argument,  nullptr, 'w'},
+            {"writer",      required_argument,  nullptr, 'q'},
+            {"prefetch",    required_argument,  nullptr, 'j'},
+            {"order",       required_argument,  nullptr, 'y'},
+            {"list",        required_argument,  nullptr, 'v'},
             {"help",        no_argument,        nullptr, 'h'},
             {nullptr,       no_argument,        nullptr, 0} // Documentation says last element must be empty.
     };
@@ -228,6 +243,24 @@ void parseSingleParameter(int c, SplitterOpts& options) {
         case 'a':
             options.subtractAlphaSpritesFromIndex = true;
             break;
+        case 'x':
+            options.reduceColors = true;
+            break;
+        case 'n':
+            options.planOnly = true;
+            break;
+        case 'e':
+            options.recompress = true;
+            break;
+        case 'b':
+            options.bundle = true;
+            break;
+        case 'l':
+            options.atlas = true;
+            break;
+        case 'm':
+            options.animate = true;
+            break;
         case 'g':
             if (optarg == nullptr) {
                 std::cout << logger::warn << "-g specified without regex literal string. Not setting -g.\n";
@@ -235,11 +268,66 @@ void parseSingleParameter(int c, SplitterOpts& options) {
                 options.groundFilePattern = RegexWrapper(std::string(optarg));
             }
             break;
+        case 'z':
+            if (optarg == nullptr || !deflateBackendFromString(optarg, options.deflateBackend)) {
+                std::cout << logger::warn << "-z expects 'lodepng', 'fast' or 'stored'. Not setting -z.\n";
+            }
+            break;
+        case 'p':
+            if (optarg == nullptr || !compressionProfileFromString(optarg, options.compressionProfile)) {
+                std::cout << logger::warn << "-p expects 'fast', 'default' or 'max'. Not setting -p.\n";
+            }
+            break;
+        case 't':
+            if (optarg == nullptr || !chunkPolicyFromString(optarg, options.chunkPolicy)) {
+                std::cout << logger::warn << "-t expects 'all', 'none' or a comma separated list of chunk types, e.g. 'tEXt,pHYs'. Not setting -t.\n";
+            }
+            break;
+        case 'f':
+            if (optarg == nullptr || !outputFormatFromString(optarg, options.outputFormat)) {
+                std::cout << logger::warn << "-f expects 'png', 'qoi' or 'rgba'. Not setting -f.\n";
+            }
+            break;
+        case 'w':
+            if (optarg == nullptr || !archiveFormatFromString(optarg, options.archiveFormat)) {
+                std::cout << logger::warn << "-w expects 'none', 'tar' or 'zip'. Not setting -w.\n";
+            }
+            break;
+        case 'q':
+            if (optarg == nullptr || !writeBackendFromString(optarg, options.writeBackend)) {
+                std::cout << logger::warn << "-q expects 'sync', 'pool' or 'uring'. Not setting -q.\n";
+            }
+            break;
+        case 'v':
+            options.fileList = optarg;
+            break;
+        case 'y':
+            if (optarg == nullptr || !readOrderFromString(optarg, options.readOrder)) {
+                std::cout << logger::warn << "-y expects 'path', 'inode' or 'extent'. Not setting -y.\n";
+            }
+            break;
+        case 'j': {
+            int amount = -1;
+            try {
+                amount = std::stoi(optarg);
+            } catch (std::logic_error& e) {
+                // reported below.
+            }
+            if (amount < 0) {
+                std::cout << logger::warn << "-j expects a number of sheets, 0 or more (" << optarg << " was supplied). Not setting -j.\n";
+            } else {
+                options.prefetch = amount;
+            }
+            break;
+        }
         case 'h':
             std::cout << "--directory (-d):          " << "Input directory.\n";
             std::cout << "                           " << "When this is a .png file, processes just this file.\n";
             std::cout << "                           " << "When a folder is specified, processes the folder based on -k.\n";
             std::cout << "--in (-i):                 " << "Alias for -d.\n";
+            std::cout << "--list (-v):               " << "Split only the .png files in this list, e.g. the output of 'git diff --name-only', instead\n";
+            std::cout << "                           " << "of all in the input folder. '-' reads the list from stdin. Paths are separated by newlines,\n";
+            std::cout << "                           " << "or by NUL if the list has any (e.g. 'git diff -z'). Relative paths are relative to -d.\n";
             std::cout << "--out (-o):                " << "The output directory.\n";
             std::cout << "                           " << "When not specified, outputs to the input directory.\n";
             std::cout << "--recursive (-r):          " << "Used when processing folders.\n";
@@ -253,6 +341,17 @@ void parseSingleParameter(int c, SplitterOpts& options) {
             std::cout << "                           " << "is subtracted from the index (numerical file name). \n";
             std::cout << "                           " << "Enabling this leads to a contiguous index,\n";
             std::cout << "                           " << "but numbers no longer directly map to positions on the original sheet.\n";
+            std::cout << "--reduceColors (-x):       " << "Used when outputting split files.\n";
+            std::cout << "                           " << "When enabled, sprites are saved as palette, gray or RGB images\n";
+            std::cout << "                           " << "whenever that loses nothing, instead of always as RGBA.\n";
+            std::cout << "--plan (-n):               " << "Dry run. Only the PNG headers are read, nothing is decoded or written.\n";
+            std::cout << "                           " << "Prints per sheet the detected type, amount of tiles and output folder,\n";
+            std::cout << "                           " << "with a rough estimate of the output size and CPU time.\n";
+            std::cout << "--recompress (-e):         " << "Instead of splitting, re-encode the saved sprites in the input folder and its subfolders\n";
+            std::cout << "                           " << "at maximum compression. A file is only replaced when it gets smaller.\n";
+            std::cout << "                           " << "Meant as the second pass after a fast write, e.g. with -z stored -p fast.\n";
+            std::cout << "                           " << "Files already recompressed are skipped, so an interrupted pass can be restarted.\n";
+            std::cout << "                           " << "So are PNGs that other tools wrote at maximum zlib level (e.g. -9), and animated PNGs.\n";
             std::cout << "--keepworking (-k) ('cap' in config):\t" << "Amount of files to process in a folder before stopping.\n";
             std::cout << "                           " << "Defaults to process the entire folder unless specified otherwise.\n";
             std::cout << "                           " << "When a k is specified, this amount of files are processed before halting.\n";
@@ -265,6 +364,38 @@ void parseSingleParameter(int c, SplitterOpts& options) {
             std::cout << "                           " << "This is necessary because Object and Ground sheets are indistinguishable\n";
             std::cout << "                           " << "By dimensions. When unspecified, the default value used is '/ground/i'.\n";
             std::cout << "--groundIndexOffset (-u):  " << "Offset to add to the naming of ground sprites. Default is 0 or 1000, depending on -s.\n";
+            std::cout << "--deflate (-z):            " << "Deflate implementation used to compress the saved sprites.\n";
+            std::cout << "                           " << "'lodepng' (default) is the reference implementation of the png library,\n";
+            std::cout << "                           " << "'fast' is an in-tree compressor that trades a little file size for speed.\n";
+            std::cout << "                           " << "'stored' does not compress at all, see --recompress.\n";
+            std::cout << "--profile (-p):            " << "How much time to spend on the file size of saved sprites.\n";
+            std::cout << "                           " << "'fast' skips PNG scanline filtering, 'default' filters only sprites that benefit,\n";
+            std::cout << "                           " << "'max' tries both for every sprite and keeps the smaller file.\n";
+            std::cout << "--chunks (-t):             " << "Which ancillary chunks of a sheet (text, gAMA, pHYs..) are copied into its sprites.\n";
+            std::cout << "                           " << "'all' (default), 'none', or a comma separated list of chunk types, e.g. 'tEXt,pHYs'.\n";
+            std::cout << "--format (-f):             " << "Image format of the saved sprites: 'png' (default), 'qoi' or 'rgba' (raw pixels, only with -b).\n";
+            std::cout << "                           " << "QOI files encode several times faster, but are larger, and carry none of the sheet's chunks.\n";
+            std::cout << "                           " << "-z, -p, -t and -x only apply to png.\n";
+            std::cout << "--bundle (-b):             " << "Write the sprites of each sheet into one '.sprites' bundle file instead of a file per sprite,\n";
+            std::cout << "                           " << "named after the folder the sprites would have gone to. See IO/bundle/SpriteBundle.hpp.\n";
+            std::cout << "--archive (-w):            " << "'tar' or 'zip': stream the sprites of the job into one archive in the output directory,\n";
+            std::cout << "                           " << "named after the input folder, instead of writing loose files. The paths inside are\n";
+            std::cout << "                           " << "the ones the loose files would have. Zip entries are stored, not compressed again.\n";
+            std::cout << "--atlas (-l):              " << "Repack the sprites of the job into atlases of at most 2048x2048 in the output directory,\n";
+            std::cout << "                           " << "named after the input folder (e.g. 'sheets_0.png'), with an index 'sheets.json' that gives\n";
+            std::cout << "                           " << "the atlas and rectangle of every sprite, by the path its loose file would have.\n";
+            std::cout << "--animate (-m):            " << "Write the five frames of each character into one animated PNG, e.g. '3_Right_Animation.png',\n";
+            std::cout << "                           " << "instead of a file per frame. Only with the 'png' format, and not with -l.\n";
+            std::cout << "--writer (-q):             " << "How loose sprite files are written. 'uring' (default) batches the open, write and close\n";
+            std::cout << "                           " << "of many files into few syscalls with io_uring, or uses 'pool' where that is unavailable.\n";
+            std::cout << "                           " << "'pool' writes from a few background threads, 'sync' from the thread that split the sheet.\n";
+            std::cout << "--prefetch (-j):           " << "How many sheets of a folder to have read from disk ahead of the threads splitting them.\n";
+            std::cout << "                           " << "Default 4, 0 to turn it off. Helps most on spinning disks and network mounts. Linux only.\n";
+            std::cout << "--order (-y):              " << "The order the sheets of a folder are split in. 'path' (default) is by folder and name.\n";
+            std::cout << "                           " << "'inode' and 'extent' are by where the sheets are on disk, for reading them close to\n";
+            std::cout << "                           " << "sequentially from cold storage. 'extent' asks the filesystem (FIEMAP), and is 'inode'\n";
+            std::cout << "                           " << "where it cannot. With -k, the first k sheets by path (with -v, the first k listed)\n";
+            std::cout << "                           " << "are split, in this order.\n";
             std::cout << "--help (-h):               " << "Display this message\n";
 
             // assume the user either wants to use the program, or get information on commands. Not at the same time!
@@ -0,0 +1,125 @@
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "lodepng.h"
+
+/**
+ * Checks that a sheet folder of an earlier run survives a run whose sprite files cannot be written: the staged folder
+ * of that run is incomplete, and must not be swapped in (see StagedOutput).
+ *
+ * Writes fail by running the splitter with a file size limit of 0 (RLIMIT_FSIZE), with SIGXFSZ ignored: files are still
+ * created, but every write to them fails with EFBIG, as on a full disk.
+ *
+ * Usage: StagedOutputTest <path to SpriteSheetSplitter>
+ */
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char* SHEET_NAME = "TestObjects8x8";
+constexpr unsigned int SHEET_WIDTH = 128; // a row of 16 objects of 8x8.
+constexpr unsigned int SHEET_HEIGHT = 8;
+
+// An object sheet without transparent sprites, whose pixels depend on seed.
+bool writeSheet(const fs::path& path, unsigned int seed) {
+    std::vector<unsigned char> pixels(SHEET_WIDTH * SHEET_HEIGHT * 4);
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        pixels[i] = static_cast<unsigned char>(i * seed);
+        pixels[i + 1] = static_cast<unsigned char>(i / 4 + seed);
+        pixels[i + 2] = static_cast<unsigned char>(seed * 40);
+        pixels[i + 3] = 255;
+    }
+    return lodepng::encode(path.string(), pixels, SHEET_WIDTH, SHEET_HEIGHT) == 0;
+}
+
+// The name and contents of every file in a folder.
+std::map<std::string, std::string> contents(const fs::path& folder) {
+    std::map<std::string, std::string> files;
+    std::error_code ec;
+    for (const fs::directory_entry& entry : fs::directory_iterator(folder, ec)) {
+        std::ifstream file(entry.path(), std::ios::binary);
+        files[entry.path().filename().string()] = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    return files;
+}
+
+// Run the splitter on in, writing to out, and return its exit status. With failWrites, no file it creates can be written to.
+int split(const std::string& splitter, const fs::path& in, const fs::path& out, const char* writer, bool failWrites) {
+    const pid_t child = fork();
+    if (child < 0) return -1;
+    if (child == 0) {
+        if (failWrites) {
+            std::signal(SIGXFSZ, SIG_IGN); // ignored signals stay ignored across exec.
+            const rlimit limit {0, 0};
+            setrlimit(RLIMIT_FSIZE, &limit);
+        }
+        const std::string inOption = "--in=" + in.string();
+        const std::string outOption = "--out=" + out.string();
+        const std::string writerOption = std::string("--writer=") + writer;
+        execl(splitter.c_str(), splitter.c_str(), inOption.c_str(), outOption.c_str(), writerOption.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    int status = 0;
+    if (waitpid(child, &status, 0) != child || !WIFEXITED(status)) return -1;
+    return WEXITSTATUS(status);
+}
+
+// One backend: a complete first run, a second run whose writes fail, and a third run that succeeds.
+bool check(const std::string& splitter, const fs::path& root, const char* writer) {
+    const fs::path in = root / writer / "in";
+    const fs::path out = root / writer / "out";
+    const fs::path folder = out / SHEET_NAME;
+    fs::create_directories(in);
+    fs::create_directories(out);
+    const fs::path sheet = in / (std::string(SHEET_NAME) + ".png");
+
+    if (!writeSheet(sheet, 1) || split(splitter, in, out, writer, false) != 0) {
+        std::cerr << writer << ": the first run failed\n";
+        return false;
+    }
+    const std::map<std::string, std::string> complete = contents(folder);
+    if (complete.size() != 16) {
+        std::cerr << writer << ": expected 16 sprites after the first run, found " << complete.size() << "\n";
+        return false;
+    }
+
+    if (!writeSheet(sheet, 2)) return false;
+    split(splitter, in, out, writer, true);
+    if (contents(folder) != complete) {
+        std::cerr << writer << ": the folder of the first run was replaced by a run that could not write its sprites\n";
+        return false;
+    }
+
+    // and a run that can write does replace it, so the test above can fail.
+    if (split(splitter, in, out, writer, false) != 0 || contents(folder) == complete || contents(folder).size() != 16) {
+        std::cerr << writer << ": the third run did not replace the folder\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <path to SpriteSheetSplitter>\n";
+        return 2;
+    }
+    const fs::path root = fs::temp_directory_path() / ("splitter-staged-output-test-" + std::to_string(getpid()));
+
+    bool ok = true;
+    for (const char* writer : {"uring", "pool", "sync"}) ok &= check(argv[1], root, writer);
+
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,96 @@
+/**
+ * Validates sprite bundles written with --bundle (see IO/bundle/SpriteBundle.hpp).
+ *
+ * For every bundle given on the command line (or every '.sprites' file in a given folder), checks:
+ * - the header and index, as SpriteBundle::open does.
+ * - that payloads do not overlap, and names are unique.
+ * - the checksum of every payload.
+ * - that every PNG or QOI payload decodes, to the dimensions the index says.
+ *
+ * Prints one line per bundle, and exits with 1 if any bundle is invalid.
+ */
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include "lodepng.h"
+#include "../IO/bundle/SpriteBundle.hpp"
+#include "../IO/codec/QoiCodec.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool validate(const std::string& path, std::string& error) {
+    SpriteBundle bundle;
+    if (!bundle.open(path, error)) return false;
+
+    std::set<std::string_view> names;
+    const unsigned char* previousEnd = nullptr;
+    for (const SpriteBundle::Sprite& sprite : bundle.sprites()) {
+        const std::string name(sprite.name);
+        if (!names.insert(sprite.name).second) {
+            error = "duplicate name '" + name + "'";
+            return false;
+        }
+        if (previousEnd && sprite.data < previousEnd) {
+            error = "payload of '" + name + "' overlaps the one before it";
+            return false;
+        }
+        previousEnd = sprite.data + sprite.size;
+        if (!SpriteBundle::verify(sprite)) {
+            error = "checksum mismatch for '" + name + "'";
+            return false;
+        }
+
+        std::vector<unsigned char> pixels;
+        unsigned w = sprite.width;
+        unsigned h = sprite.height;
+        bool decoded = true;
+        switch (bundle.payload()) {
+            case SpriteBundle::Payload::RGBA:
+                break; // SpriteBundle::open checked the size.
+            case SpriteBundle::Payload::PNG:
+                decoded = lodepng::decode(pixels, w, h, sprite.data, sprite.size) == 0;
+                break;
+            case SpriteBundle::Payload::QOI:
+                decoded = QoiCodec::decode(pixels, w, h, sprite.data, sprite.size);
+                break;
+        }
+        if (!decoded || w != sprite.width || h != sprite.height) {
+            error = "payload of '" + name + "' does not decode to " + std::to_string(sprite.width) + "x" + std::to_string(sprite.height);
+            return false;
+        }
+    }
+    error = std::to_string(bundle.sprites().size()) + " sprites";
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " <bundle or folder>...\n";
+        return 2;
+    }
+
+    std::vector<std::string> bundles;
+    for (int i = 1; i < argc; ++i) {
+        if (fs::is_directory(argv[i])) {
+            for (const auto& entry : fs::recursive_directory_iterator(argv[i])) {
+                if (entry.path().extension() == SpriteBundle::EXTENSION) bundles.push_back(entry.path().string());
+            }
+        } else {
+            bundles.emplace_back(argv[i]);
+        }
+    }
+
+    unsigned int invalid = 0;
+    for (const std::string& path : bundles) {
+        std::string message;
+        const bool valid = validate(path, message);
+        invalid += !valid;
+        std::cout << (valid ? "OK      " : "INVALID ") << path << ": " << message << "\n";
+    }
+    std::cout << bundles.size() - invalid << " of " << bundles.size() << " bundles valid.\n";
+    return invalid ? 1 : 0;
+}
@@ -0,0 +1,43 @@
+#ifndef SPRITESHEETSPLITTER_ARCHIVEFORMAT_H
+#define SPRITESHEETSPLITTER_ARCHIVEFORMAT_H
+
+#include <string>
+#include <ostream>
+
+// Whether the saved sprites of a job are written as loose files, or streamed into one archive. See IO/archive.
+enum class ArchiveFormat {
+    NONE = 0,
+    TAR = 1, // POSIX ustar.
+    ZIP = 2, // without compression ('stored'): the sprites are compressed already.
+};
+
+inline std::ostream& operator<<(std::ostream& os, const ArchiveFormat& af) {
+    switch (af) {
+        case ArchiveFormat::NONE:
+            os << "none";
+            break;
+        case ArchiveFormat::TAR:
+            os << "tar";
+            break;
+        case ArchiveFormat::ZIP:
+            os << "zip";
+            break;
+    }
+    return os;
+}
+
+// Parse the user facing name of an ArchiveFormat (as printed by operator<<). Returns false if the name is unknown.
+inline bool archiveFormatFromString(const std::string& s, ArchiveFormat& out) {
+    if (s == "none") {
+        out = ArchiveFormat::NONE;
+    } else if (s == "tar") {
+        out = ArchiveFormat::TAR;
+    } else if (s == "zip") {
+        out = ArchiveFormat::ZIP;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#endif //SPRITESHEETSPLITTER_ARCHIVEFORMAT_H
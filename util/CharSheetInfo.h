@@ -33,6 +33,10 @@ static const std::map<CharSheetInfo, std::string> CHAR_SHEET_TYPE_TO_NAME { // N
         {CharSheetInfo::ATTACK_2, "Right_Attack_1"},
 };
 
+// file name (after the index) of the animated PNG of a character, holding all of its frames. See SpriteSheetIO::saveCharAnimation.
+static const std::string CHAR_ANIMATION_NAME = "Right_Animation"; // NOLINT(cert-err58-cpp)
+constexpr static unsigned int CHAR_FRAME_DELAY_MS = 150; // how long each frame of the animation is shown: a preview speed, not the game's.
+
 // needs c++20 constexpr containers, no compiler support yet (assuming map gets constexpr at all, not entirely clear on that! They mention containers _such as_ vector and string, but cant find examples of anything other than these two...).
 //static_assert(SPRITES_PER_CHAR == CHAR_SHEET_TYPE_TO_NAME.size());
 static_assert(SPRITES_PER_CHAR == to_integral(CharSheetInfo::ATTACK_2) + 1);
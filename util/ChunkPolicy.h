@@ -0,0 +1,88 @@
+#ifndef SPRITESHEETSPLITTER_CHUNKPOLICY_H
+#define SPRITESHEETSPLITTER_CHUNKPOLICY_H
+
+#include <string>
+#include <ostream>
+#include <vector>
+
+// Which ancillary chunks of a sheet (text, gAMA, pHYs, unknown chunks..) are copied into every saved sprite.
+// Critical chunks (IHDR, PLTE, IDAT, IEND) and tRNS are always written: they belong to the sprite itself.
+struct ChunkPolicy {
+    enum class Mode {
+        ALL = 0,
+        NONE = 1,
+        LISTED = 2, // only the chunk types in 'types'
+    };
+
+    Mode mode;
+    std::vector<std::string> types; // 4 character chunk types, only used when LISTED.
+
+    ChunkPolicy() : mode(Mode::ALL) {}
+
+    [[nodiscard]] bool keeps(const std::string& type) const {
+        switch (mode) {
+            case Mode::ALL:
+                return true;
+            case Mode::NONE:
+                return false;
+            case Mode::LISTED:
+                for (const auto& t : types) {
+                    if (t == type) return true;
+                }
+                return false;
+        }
+        return true;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const ChunkPolicy& cp) {
+    switch (cp.mode) {
+        case ChunkPolicy::Mode::ALL:
+            os << "all";
+            break;
+        case ChunkPolicy::Mode::NONE:
+            os << "none";
+            break;
+        case ChunkPolicy::Mode::LISTED:
+            for (size_t i = 0; i < cp.types.size(); ++i) {
+                os << (i ? "," : "") << cp.types[i];
+            }
+            break;
+    }
+    return os;
+}
+
+// Parse the user facing form of a ChunkPolicy (as printed by operator<<): 'all', 'none', or a comma separated list of chunk types.
+// Returns false if it is neither, or a listed type is not 4 letters.
+inline bool chunkPolicyFromString(const std::string& s, ChunkPolicy& out) {
+    if (s == "all") {
+        out.mode = ChunkPolicy::Mode::ALL;
+        out.types.clear();
+        return true;
+    }
+    if (s == "none") {
+        out.mode = ChunkPolicy::Mode::NONE;
+        out.types.clear();
+        return true;
+    }
+
+    std::vector<std::string> types;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t end = s.find(',', start);
+        if (end == std::string::npos) end = s.size();
+        std::string type = s.substr(start, end - start);
+        if (type.size() != 4) return false;
+        for (char c : type) {
+            if (! ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))) return false;
+        }
+        types.emplace_back(std::move(type));
+        start = end + 1;
+    }
+
+    out.mode = ChunkPolicy::Mode::LISTED;
+    out.types = std::move(types);
+    return true;
+}
+
+#endif //SPRITESHEETSPLITTER_CHUNKPOLICY_H
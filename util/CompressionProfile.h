@@ -0,0 +1,43 @@
+#ifndef SPRITESHEETSPLITTER_COMPRESSIONPROFILE_H
+#define SPRITESHEETSPLITTER_COMPRESSIONPROFILE_H
+
+#include <string>
+#include <ostream>
+
+// How much encode time to spend on the size of saved sprites. See IO/codec/SpriteEncoder for what each profile does.
+enum class CompressionProfile {
+    FAST = 0,
+    DEFAULT = 1,
+    MAX = 2,
+};
+
+inline std::ostream& operator<<(std::ostream& os, const CompressionProfile& cp) {
+    switch (cp) {
+        case CompressionProfile::FAST:
+            os << "fast";
+            break;
+        case CompressionProfile::DEFAULT:
+            os << "default";
+            break;
+        case CompressionProfile::MAX:
+            os << "max";
+            break;
+    }
+    return os;
+}
+
+// Parse the user facing name of a CompressionProfile (as printed by operator<<). Returns false if the name is unknown.
+inline bool compressionProfileFromString(const std::string& s, CompressionProfile& out) {
+    if (s == "fast") {
+        out = CompressionProfile::FAST;
+    } else if (s == "default") {
+        out = CompressionProfile::DEFAULT;
+    } else if (s == "max") {
+        out = CompressionProfile::MAX;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#endif //SPRITESHEETSPLITTER_COMPRESSIONPROFILE_H
@@ -0,0 +1,45 @@
+#ifndef SPRITESHEETSPLITTER_DEFLATEBACKEND_H
+#define SPRITESHEETSPLITTER_DEFLATEBACKEND_H
+
+#include <string>
+#include <ostream>
+
+// Which deflate implementation compresses the IDAT of saved sprites.
+// LODEPNG is the library's built-in compressor, kept as reference. FAST is the in-tree IO/codec/FastDeflate.
+// STORED does not compress at all (deflate block type 0): the quickest to write, meant to be followed by a --recompress pass.
+enum class DeflateBackend {
+    LODEPNG = 0,
+    FAST = 1,
+    STORED = 2,
+};
+
+inline std::ostream& operator<<(std::ostream& os, const DeflateBackend& db) {
+    switch (db) {
+        case DeflateBackend::LODEPNG:
+            os << "lodepng";
+            break;
+        case DeflateBackend::FAST:
+            os << "fast";
+            break;
+        case DeflateBackend::STORED:
+            os << "stored";
+            break;
+    }
+    return os;
+}
+
+// Parse the user facing name of a DeflateBackend (as printed by operator<<). Returns false if the name is unknown.
+inline bool deflateBackendFromString(const std::string& s, DeflateBackend& out) {
+    if (s == "lodepng") {
+        out = DeflateBackend::LODEPNG;
+    } else if (s == "fast") {
+        out = DeflateBackend::FAST;
+    } else if (s == "stored") {
+        out = DeflateBackend::STORED;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#endif //SPRITESHEETSPLITTER_DEFLATEBACKEND_H
@@ -0,0 +1,56 @@
+#ifndef SPRITESHEETSPLITTER_OUTPUTFORMAT_H
+#define SPRITESHEETSPLITTER_OUTPUTFORMAT_H
+
+#include <string>
+#include <ostream>
+
+// The image format saved sprites are written in. See IO/codec/QoiCodec for QOI.
+enum class OutputFormat {
+    PNG = 0,
+    QOI = 1, // "Quite OK Image" format: lossless, encoded in one linear pass. No compression settings or chunks apply.
+    RGBA = 2, // the pixels as they are, 4 bytes each. Only for bundles, which record the dimensions.
+};
+
+inline std::ostream& operator<<(std::ostream& os, const OutputFormat& of) {
+    switch (of) {
+        case OutputFormat::PNG:
+            os << "png";
+            break;
+        case OutputFormat::QOI:
+            os << "qoi";
+            break;
+        case OutputFormat::RGBA:
+            os << "rgba";
+            break;
+    }
+    return os;
+}
+
+// Parse the user facing name of an OutputFormat (as printed by operator<<). Returns false if the name is unknown.
+inline bool outputFormatFromString(const std::string& s, OutputFormat& out) {
+    if (s == "png") {
+        out = OutputFormat::PNG;
+    } else if (s == "qoi") {
+        out = OutputFormat::QOI;
+    } else if (s == "rgba") {
+        out = OutputFormat::RGBA;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// File extension of saved sprites, including the dot.
+inline const char* fileExtension(OutputFormat of) {
+    switch (of) {
+        case OutputFormat::QOI:
+            return ".qoi";
+        case OutputFormat::RGBA:
+            return ".rgba";
+        case OutputFormat::PNG:
+        default:
+            return ".png";
+    }
+}
+
+#endif //SPRITESHEETSPLITTER_OUTPUTFORMAT_H
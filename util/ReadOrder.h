@@ -0,0 +1,45 @@
+#ifndef SPRITESHEETSPLITTER_READORDER_H
+#define SPRITESHEETSPLITTER_READORDER_H
+
+#include <string>
+#include <ostream>
+
+// The order in which the sheets of a folder are split. See IO/file/DiskOrder.
+// PATH is the order of their paths. INODE sorts them by inode number, which most filesystems allocate close to the data.
+// EXTENT sorts them by the physical offset of their first extent (FIEMAP), and is INODE where that is unavailable.
+enum class ReadOrder {
+    PATH = 0,
+    INODE = 1,
+    EXTENT = 2,
+};
+
+inline std::ostream& operator<<(std::ostream& os, const ReadOrder& ro) {
+    switch (ro) {
+        case ReadOrder::PATH:
+            os << "path";
+            break;
+        case ReadOrder::INODE:
+            os << "inode";
+            break;
+        case ReadOrder::EXTENT:
+            os << "extent";
+            break;
+    }
+    return os;
+}
+
+// Parse the user facing name of a ReadOrder (as printed by operator<<). Returns false if the name is unknown.
+inline bool readOrderFromString(const std::string& s, ReadOrder& out) {
+    if (s == "path") {
+        out = ReadOrder::PATH;
+    } else if (s == "inode") {
+        out = ReadOrder::INODE;
+    } else if (s == "extent") {
+        out = ReadOrder::EXTENT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#endif //SPRITESHEETSPLITTER_READORDER_H
@@ -5,22 +5,44 @@
 #include <iostream>
 #include <limits>
 #include "RegexWrapper.hpp"
+#include "DeflateBackend.h"
+#include "CompressionProfile.h"
+#include "ChunkPolicy.h"
+#include "OutputFormat.h"
+#include "ArchiveFormat.h"
+#include "WriteBackend.h"
+#include "ReadOrder.h"
 
 struct SplitterOpts {
     std::string inDirectory; // for both --in and --directory. uses isPNGDirectory to decide which it is. Cannot have both.
     std::string outDirectory;
+    std::string fileList; // a list of the sheets to split, instead of all in inDirectory. "-" for stdin.
     RegexWrapper groundFilePattern;
+    DeflateBackend deflateBackend;
+    CompressionProfile compressionProfile;
+    ChunkPolicy chunkPolicy;
+    OutputFormat outputFormat;
+    ArchiveFormat archiveFormat;
+    WriteBackend writeBackend; // how loose sprite files are written.
+    ReadOrder readOrder; // the order the sheets of a folder are split in.
     int workAmount;
+    int prefetch; // how many sheets to have read ahead of the threads splitting them.
     std::pair<bool,int> groundIndexOffset; // user specified, value
     bool isPNGInDirectory;
     bool recursive;
     bool useSubFoldersInOutput;
     bool subtractAlphaSpritesFromIndex;
+    bool reduceColors;
+    bool planOnly; // only read PNG headers, and print what splitting would do.
+    bool bundle; // write the sprites of each sheet into one bundle file, instead of a file per sprite.
+    bool atlas; // repack the sprites of the job into atlas images with a JSON index, instead of a file per sprite.
+    bool animate; // write the frames of each character into one animated PNG, instead of a file per frame.
+    bool recompress; // re-encode the saved sprites in inDirectory at maximum compression, instead of splitting.
 
     SplitterOpts()
-        :   groundFilePattern(RegexWrapper("/ground/i")), workAmount(0), groundIndexOffset(std::make_pair(false, 0)), isPNGInDirectory(false),
+        :   groundFilePattern(RegexWrapper("/ground/i")), deflateBackend(DeflateBackend::LODEPNG), compressionProfile(CompressionProfile::DEFAULT), chunkPolicy(), outputFormat(OutputFormat::PNG), archiveFormat(ArchiveFormat::NONE), writeBackend(WriteBackend::URING), readOrder(ReadOrder::PATH), workAmount(0), prefetch(4), groundIndexOffset(std::make_pair(false, 0)), isPNGInDirectory(false),
             recursive(false), useSubFoldersInOutput(true),
-            subtractAlphaSpritesFromIndex(false) {}
+            subtractAlphaSpritesFromIndex(false), reduceColors(false), planOnly(false), bundle(false), atlas(false), animate(false), recompress(false) {}
 
     // This is more rigorously tested by the std::filesystem class further in execution (if the file exists & if it can be loaded).
     // All that matters for now, is if the user _intends_ to run it on a directory pointing to an alleged 'png'.
@@ -33,13 +55,28 @@ inline std::ostream&operator<<(std::ostream &o, const SplitterOpts& s) {
     o << "SplitterOptions:\n";
     o << "\tinDir: " << s.inDirectory << "\n";
     o << "\toutDir: " << s.outDirectory << "\n";
+    if (! s.fileList.empty()) o << "\tlist: " << s.fileList << "\n";
     o << "\tgroundFilePattern: " << s.groundFilePattern << "\n";
+    o << "\tdeflateBackend: " << s.deflateBackend << "\n";
+    o << "\tcompressionProfile: " << s.compressionProfile << "\n";
+    o << "\tchunks: " << s.chunkPolicy << "\n";
+    o << "\tformat: " << s.outputFormat << "\n";
+    o << "\tarchive: " << s.archiveFormat << "\n";
+    o << "\twriter: " << s.writeBackend << "\n";
+    o << "\torder: " << s.readOrder << "\n";
     o << "\tgroundSpriteOffset: " << s.groundIndexOffset.second << "\n";
     o << "\tworkAmount: " << (s.workAmount == std::numeric_limits<int>::max() ? "infinite" : std::to_string(s.workAmount)) << "\n";
+    o << "\tprefetch: " << s.prefetch << "\n";
     o << "\tisPathToPNG?: " << (s.isPNGInDirectory ? "true" : "false") << "\n";
     o << "\trecursive?: " << (s.recursive ? "true" : "false") << "\n";
     o << "\tuseSubFoldersInOutput?: " << (s.useSubFoldersInOutput ? "true" : "false") << "\n";
     o << "\tsubtractAlphaSpritesFromIndex?: " << (s.subtractAlphaSpritesFromIndex ? "true" : "false") << "\n";
+    o << "\treduceColors?: " << (s.reduceColors ? "true" : "false") << "\n";
+    o << "\tplanOnly?: " << (s.planOnly ? "true" : "false") << "\n";
+    o << "\tbundle?: " << (s.bundle ? "true" : "false") << "\n";
+    o << "\tatlas?: " << (s.atlas ? "true" : "false") << "\n";
+    o << "\tanimate?: " << (s.animate ? "true" : "false") << "\n";
+    o << "\trecompress?: " << (s.recompress ? "true" : "false") << "\n";
     return o;
 }
 
@@ -6,6 +6,7 @@ struct SpriteSheetPNGData {
     unsigned int width;
     unsigned int height;
     unsigned int error;
+    size_t fileSize; // set by loadPNG.
     lodepng::State lodeState;
 
     SpriteSheetPNGData() {
@@ -21,6 +22,7 @@ struct SpriteSheetPNGData {
         width = 0;
         height = 0;
         error = 0;
+        fileSize = 0;
     }
 };
 #endif //SPRITESHEETSPLITTER_SPRITESHEETPNGDATA_H
@@ -6,8 +6,16 @@ struct SpriteSplittingStatus {
     unsigned int n_save_error;
     unsigned int n_success;
     unsigned int n_skipped; // e.g. fully alpha.
-
-    SpriteSplittingStatus() : n_load_error(0), n_save_error(0), n_success(0), n_skipped(0) {}
+    unsigned int n_decode_avoided; // PNGs rejected from their header alone, without decoding the pixels.
+    double load_seconds_blocked; // time spent waiting for sheets to be read from disk, over all threads. See --prefetch.
+    unsigned long long load_bytes; // size of the sheets read, for the read throughput: see --order.
+    unsigned long long chunk_bytes_saved; // ancillary chunks of sheets left out of the sprites, by the chunk policy.
+    double chunk_seconds_saved; // estimated time saved by serializing the kept chunks once per sheet, instead of per sprite.
+    unsigned int n_recompressed; // saved sprites replaced by a smaller encode, see --recompress.
+    unsigned int n_recompress_skipped; // saved sprites left as they were: already recompressed, or the encode was not smaller.
+    unsigned long long recompress_bytes_saved;
+
+    SpriteSplittingStatus() : n_load_error(0), n_save_error(0), n_success(0), n_skipped(0), n_decode_avoided(0), load_seconds_blocked(0), load_bytes(0), chunk_bytes_saved(0), chunk_seconds_saved(0), n_recompressed(0), n_recompress_skipped(0), recompress_bytes_saved(0) {}
 };
 
 inline SpriteSplittingStatus& operator+(SpriteSplittingStatus& lhs, const SpriteSplittingStatus& rhs) {
@@ -15,6 +23,14 @@ inline SpriteSplittingStatus& operator+(SpriteSplittingStatus& lhs, const Sprite
     lhs.n_save_error += rhs.n_save_error;
     lhs.n_success += rhs.n_success;
     lhs.n_skipped += rhs.n_skipped;
+    lhs.n_decode_avoided += rhs.n_decode_avoided;
+    lhs.load_seconds_blocked += rhs.load_seconds_blocked;
+    lhs.load_bytes += rhs.load_bytes;
+    lhs.chunk_bytes_saved += rhs.chunk_bytes_saved;
+    lhs.chunk_seconds_saved += rhs.chunk_seconds_saved;
+    lhs.n_recompressed += rhs.n_recompressed;
+    lhs.n_recompress_skipped += rhs.n_recompress_skipped;
+    lhs.recompress_bytes_saved += rhs.recompress_bytes_saved;
 
     return lhs;
 }
@@ -28,7 +44,15 @@ inline std::ostream& operator<<(std::ostream &o, const SpriteSplittingStatus& ss
         << "\t"     << sst.n_success << " Sprites created from splitting."
         << "\n\t"   << sst.n_skipped << " Pure alpha sprites ignored."
         << "\n\t"   << sst.n_load_error << " File loading errors."
-        << "\n\t"   << sst.n_save_error << " File saving errors." << "\n";
+        << "\n\t"   << sst.n_decode_avoided << " Decodes avoided by rejecting non-sheets from their header."
+        << "\n\t"   << sst.load_bytes << " Bytes of sheets read."
+        << "\n\t"   << sst.load_seconds_blocked << " Seconds spent waiting for sheets to be read."
+        << "\n\t"   << sst.n_save_error << " File saving errors."
+        << "\n\t"   << sst.chunk_bytes_saved << " Bytes of sheet chunks left out of sprites."
+        << "\n\t~"  << sst.chunk_seconds_saved << " Seconds saved by writing sheet chunks once per sheet."
+        << "\n\t"   << sst.n_recompressed << " Sprites recompressed."
+        << "\n\t"   << sst.n_recompress_skipped << " Sprites already recompressed, or not smaller when recompressed."
+        << "\n\t"   << sst.recompress_bytes_saved << " Bytes saved by recompressing." << "\n";
 
     return o;
 }
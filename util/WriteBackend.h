@@ -0,0 +1,45 @@
+#ifndef SPRITESHEETSPLITTER_WRITEBACKEND_H
+#define SPRITESHEETSPLITTER_WRITEBACKEND_H
+
+#include <string>
+#include <ostream>
+
+// How loose sprite files are written. See IO/file/FileWriter.
+// SYNC writes each file from the thread that encoded it, as it is encoded. POOL hands files to a few writer threads.
+// URING batches the open, write and close of many files into io_uring submissions, and falls back to POOL where io_uring is unavailable.
+enum class WriteBackend {
+    SYNC = 0,
+    POOL = 1,
+    URING = 2,
+};
+
+inline std::ostream& operator<<(std::ostream& os, const WriteBackend& wb) {
+    switch (wb) {
+        case WriteBackend::SYNC:
+            os << "sync";
+            break;
+        case WriteBackend::POOL:
+            os << "pool";
+            break;
+        case WriteBackend::URING:
+            os << "uring";
+            break;
+    }
+    return os;
+}
+
+// Parse the user facing name of a WriteBackend (as printed by operator<<). Returns false if the name is unknown.
+inline bool writeBackendFromString(const std::string& s, WriteBackend& out) {
+    if (s == "sync") {
+        out = WriteBackend::SYNC;
+    } else if (s == "pool") {
+        out = WriteBackend::POOL;
+    } else if (s == "uring") {
+        out = WriteBackend::URING;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#endif //SPRITESHEETSPLITTER_WRITEBACKEND_H